@@ -0,0 +1,252 @@
+"""
+popsnapshot.py
+
+Read, inspect, and convert binary population snapshots (pop_[update].popb files; see source/PopSnapshot.h).
+
+Commands:
+- info [snapshot.popb]: Print header info (update, organism count, MAP axes, instruction library).
+- to-text [snapshot.popb]: Convert to the text format written by the experiment (pop_[update].pop).
+- to-binary [snapshot.pop] -like [reference.popb]: Convert a text snapshot back to binary format. Text snapshots
+  don't include the instruction library, MAP axes, or world size, so we borrow those from a reference
+  binary snapshot from the same treatment.
+
+Notes:
+- Text -> binary conversion keeps only the precision printed in the text file (e.g., fitness).
+- ScopeGP (AvidaGP) text only lists the arguments each instruction uses; unused arguments come back as 0.
+- Text output for ScopeGP (AvidaGP) programs does not include scope indentation/annotations.
+- PopSnapshot can be imported by other scripts to random-access organisms by cell without parsing everything:
+    snap = PopSnapshot("pop_10000.popb"); org = snap.org(cell)
+
+"""
+
+import argparse, os, mmap, re, struct
+
+MAGIC = b"MAPEPOPB"
+VERSION = 1
+KIND_SIGNALGP = 0
+KIND_AVIDAGP = 1
+FLAG_BLOCK_DEF = 1
+FLAG_BLOCK_CLOSE = 2
+
+# magic, version, kind, update, cell_cnt, org_cnt, axis_cnt, tag_width, arg_cnt, inst_lib_cnt, meta_bytes
+HEADER = struct.Struct("<8sIIQQQIIIIQ")
+
+def pad(buf, align):
+    """
+    Pad bytearray buf with zeros out to a multiple of align bytes.
+    """
+    buf.extend(b"\0" * ((align - len(buf) % align) % align))
+
+class PopSnapshot(object):
+    """
+    Memory-mapped binary population snapshot.
+    """
+    def __init__(self, fpath):
+        self.fp = open(fpath, "rb")
+        self.buf = mmap.mmap(self.fp.fileno(), 0, access=mmap.ACCESS_READ)
+        (magic, version, self.kind, self.update, self.cell_cnt, self.org_cnt, axis_cnt, self.tag_width,
+         self.arg_cnt, inst_lib_cnt, meta_bytes) = HEADER.unpack_from(self.buf, 0)
+        if (magic != MAGIC): raise ValueError("{} is not a binary population snapshot.".format(fpath))
+        if (version != VERSION): raise ValueError("Unsupported population snapshot version ({}).".format(version))
+        self.tag_words = (self.tag_width + 31) // 32
+        ptr = HEADER.size
+        self.axes = []      # [(name, bin count)]
+        for _ in range(axis_cnt):
+            size, name_len = struct.unpack_from("<II", self.buf, ptr)
+            self.axes.append((self.buf[ptr+8:ptr+8+name_len].decode(), size))
+            ptr += 8 + ((name_len + 3) // 4) * 4
+        self.inst_lib = []  # [(name, arg count, flags)]
+        for _ in range(inst_lib_cnt):
+            num_args, flags, name_len = struct.unpack_from("<III", self.buf, ptr)
+            self.inst_lib.append((self.buf[ptr+12:ptr+12+name_len].decode(), num_args, flags))
+            ptr += 12 + ((name_len + 3) // 4) * 4
+        self.index_start = HEADER.size + meta_bytes
+
+    def close(self):
+        self.buf.close()
+        self.fp.close()
+
+    def cell_offset(self, cell):
+        return struct.unpack_from("<Q", self.buf, self.index_start + 8 * cell)[0]
+
+    def occupied(self, cell):
+        return self.cell_offset(cell) != 0
+
+    def cells(self):
+        """
+        Occupied cells (in order).
+        """
+        offsets = struct.unpack_from("<{}Q".format(self.cell_cnt), self.buf, self.index_start)
+        return [cell for cell in range(self.cell_cnt) if offsets[cell]]
+
+    def org(self, cell):
+        """
+        Decode organism in given cell. Returns dictionary with id, fitness, sim_thresh, bins, and functions,
+        where functions is a list of (tag, [(inst_id, args, tag)]) and tags are integers (bit i = tag bit i).
+        """
+        ptr = self.cell_offset(cell)
+        if (not ptr): return None
+        fitness, sim_thresh, cell_id, func_cnt = struct.unpack_from("<ddII", self.buf, ptr)
+        ptr += 24
+        bins = list(struct.unpack_from("<{}I".format(len(self.axes)), self.buf, ptr))
+        ptr += ((4 * len(self.axes) + 24 + 7) // 8) * 8 - 24
+        inst_fmt = struct.Struct("<I{}i{}I".format(self.arg_cnt, self.tag_words))
+        functions = []
+        for _ in range(func_cnt):
+            tag = self.read_tag(ptr)
+            ptr += 4 * self.tag_words
+            inst_cnt = struct.unpack_from("<I", self.buf, ptr)[0]
+            ptr += 4
+            insts = []
+            for _ in range(inst_cnt):
+                vals = inst_fmt.unpack_from(self.buf, ptr)
+                insts.append((vals[0], list(vals[1:1+self.arg_cnt]), self.read_tag(ptr + 4 + 4 * self.arg_cnt)))
+                ptr += inst_fmt.size
+            functions.append((tag, insts))
+        return {"id":cell_id, "fitness":fitness, "sim_thresh":sim_thresh, "bins":bins, "functions":functions}
+
+    def read_tag(self, ptr):
+        tag = 0
+        for i in range(self.tag_words):
+            tag |= struct.unpack_from("<I", self.buf, ptr + 4 * i)[0] << (32 * i)
+        return tag
+
+def tag_str(tag, width):
+    """
+    Tag as printed by emp::BitSet::Print (highest bit first).
+    """
+    return "".join("1" if (tag >> i) & 1 else "0" for i in range(width - 1, -1, -1))
+
+def fmt_num(val):
+    """
+    Mimic default C++ ostream formatting of doubles (6 significant digits).
+    """
+    return "{:g}".format(val)
+
+def to_text(snap, out):
+    for cell in snap.cells():
+        org = snap.org(cell)
+        if (snap.kind == KIND_SIGNALGP):
+            info = ["id:{}".format(org["id"]), "fitness:{}".format(fmt_num(org["fitness"])), "sim_thresh:{}".format(fmt_num(org["sim_thresh"]))]
+            info += ["{}__bin:{}".format(snap.axes[i][0], org["bins"][i]) for i in range(len(snap.axes))]
+            out.write("==={" + ",".join(info) + "}===\n")
+            for fID, (ftag, insts) in enumerate(org["functions"]):
+                out.write("Fn-{} {}:\n".format(fID, tag_str(ftag, snap.tag_width)))
+                depth = 0
+                for inst_id, args, itag in insts:
+                    name, num_args, flags = snap.inst_lib[inst_id]
+                    out.write(" " * (2 + 2 * depth) + "{}[{}]({})\n".format(name, tag_str(itag, snap.tag_width), ",".join(str(a) for a in args)))
+                    if (flags & FLAG_BLOCK_DEF): depth += 1
+                    elif (flags & FLAG_BLOCK_CLOSE and depth > 0): depth -= 1
+        else:
+            out.write("===\n")
+            out.write("id: {}, {}, fitness: {}\n".format(org["id"], ", ".join("{}: {}".format(snap.axes[i][0], org["bins"][i]) for i in range(len(snap.axes))), fmt_num(org["fitness"])))
+            for _, insts in org["functions"]:
+                for inst_id, args, _ in insts:
+                    name, num_args, _ = snap.inst_lib[inst_id]
+                    out.write(" ".join([name] + [str(a) for a in args[:num_args]]) + "\n")
+
+def parse_text(fpath, kind):
+    """
+    Parse text snapshot. Returns list of organisms in the same form as PopSnapshot.org, except that
+    bins is a dictionary (axis name => bin) and instructions are named rather than numbered.
+    """
+    orgs = []
+    with open(fpath, "r") as fp: lines = fp.readlines()
+    i = 0
+    while (i < len(lines)):
+        line = lines[i].strip()
+        i += 1
+        if (kind == KIND_SIGNALGP and line.startswith("==={")):
+            fields = dict(pair.split(":") for pair in line[4:-4].split(","))
+            org = {"id":int(fields["id"]), "fitness":float(fields["fitness"]), "sim_thresh":float(fields["sim_thresh"]),
+                   "bins":{k[:-len("__bin")]:int(v) for k, v in fields.items() if k.endswith("__bin")}, "functions":[]}
+            orgs.append(org)
+        elif (kind == KIND_SIGNALGP and line.startswith("Fn-")):
+            org["functions"].append((int(line.split(" ")[1].rstrip(":"), 2), []))
+        elif (kind == KIND_SIGNALGP and line):
+            m = re.match(r"(\S+)\[([01]*)\]\(([-\d,]*)\)", line)
+            if (m == None): raise ValueError("Failed to parse instruction: {}".format(line))
+            args = [int(a) for a in m.group(3).split(",") if a != ""]
+            org["functions"][-1][1].append((m.group(1), args, int(m.group(2), 2) if m.group(2) else 0))
+        elif (kind == KIND_AVIDAGP and line == "==="):
+            fields = dict(pair.strip().split(": ") for pair in lines[i].strip().split(","))
+            i += 1
+            org = {"id":int(fields["id"]), "fitness":float(fields["fitness"]), "sim_thresh":0.0,
+                   "bins":{k:int(v) for k, v in fields.items() if k not in ["id", "fitness"]}, "functions":[(0, [])]}
+            orgs.append(org)
+        elif (kind == KIND_AVIDAGP and line):
+            tokens = line.split("-->")[0].split()
+            org["functions"][0][1].append((tokens[0], [int(a) for a in tokens[1:]], 0))
+    return orgs
+
+def to_binary(orgs, like, update, fpath):
+    inst_ids = {like.inst_lib[i][0]:i for i in range(len(like.inst_lib))}
+    meta = bytearray()
+    for name, size in like.axes:
+        meta += struct.pack("<II", size, len(name)) + name.encode()
+        pad(meta, 4)
+    for name, num_args, flags in like.inst_lib:
+        meta += struct.pack("<III", num_args, flags, len(name)) + name.encode()
+        pad(meta, 4)
+    pad(meta, 8)
+    records_start = HEADER.size + len(meta) + 8 * like.cell_cnt
+    offsets = [0] * like.cell_cnt
+    records = bytearray()
+    tag_fmt = "<{}I".format(like.tag_words)
+    split_tag = lambda tag: struct.pack(tag_fmt, *[(tag >> (32 * w)) & 0xFFFFFFFF for w in range(like.tag_words)])
+    for org in orgs:
+        pad(records, 8)
+        offsets[org["id"]] = records_start + len(records)
+        records += struct.pack("<ddII", org["fitness"], org["sim_thresh"], org["id"], len(org["functions"]))
+        records += struct.pack("<{}I".format(len(like.axes)), *[org["bins"][name] for name, _ in like.axes])
+        pad(records, 8)
+        for ftag, insts in org["functions"]:
+            records += split_tag(ftag) + struct.pack("<I", len(insts))
+            for name, args, itag in insts:
+                args = (args + [0] * like.arg_cnt)[:like.arg_cnt]
+                records += struct.pack("<I{}i".format(like.arg_cnt), inst_ids[name], *args) + split_tag(itag)
+    pad(records, 8)
+    header = HEADER.pack(MAGIC, VERSION, like.kind, update, like.cell_cnt, len(orgs), len(like.axes), like.tag_width,
+                         like.arg_cnt, len(like.inst_lib), len(meta))
+    with open(fpath, "wb") as fp:
+        fp.write(header)
+        fp.write(meta)
+        fp.write(struct.pack("<{}Q".format(like.cell_cnt), *offsets))
+        fp.write(records)
+
+def main():
+    parser = argparse.ArgumentParser(description="population snapshot conversion script")
+    parser.add_argument("command", type=str, choices=["info", "to-text", "to-binary"], help="What should we do?")
+    parser.add_argument("snapshot", type=str, help="Snapshot file to read.")
+    parser.add_argument("-o", "--output", type=str, help="Where to write converted snapshot. Default = input path with extension swapped.")
+    parser.add_argument("-like", type=str, help="to-binary: reference binary snapshot (instruction library, MAP axes, world size).")
+    parser.add_argument("-u", "--update", type=int, help="to-binary: update of snapshot. Default = parsed from file name (pop_[update].pop).")
+
+    args = parser.parse_args()
+    if (not os.path.isfile(args.snapshot)): exit("Failed to find snapshot file ({}). Exiting...".format(args.snapshot))
+
+    if (args.command == "info"):
+        snap = PopSnapshot(args.snapshot)
+        print("Kind: {}".format("SignalGP" if snap.kind == KIND_SIGNALGP else "AvidaGP"))
+        print("Update: {}".format(snap.update))
+        print("Organisms: {} (of {} cells)".format(snap.org_cnt, snap.cell_cnt))
+        print("Axes: {}".format(", ".join("{} ({})".format(name, size) for name, size in snap.axes)))
+        print("Instructions: {}".format(", ".join(name for name, _, _ in snap.inst_lib)))
+        snap.close()
+    elif (args.command == "to-text"):
+        snap = PopSnapshot(args.snapshot)
+        out_fpath = args.output if (args.output != None) else os.path.splitext(args.snapshot)[0] + ".pop"
+        with open(out_fpath, "w") as fp: to_text(snap, fp)
+        snap.close()
+    elif (args.command == "to-binary"):
+        if (args.like == None): exit("to-binary requires a reference binary snapshot (-like). Exiting...")
+        like = PopSnapshot(args.like)
+        update = args.update
+        if (update == None): update = int(os.path.splitext(os.path.basename(args.snapshot))[0].split("_")[-1])
+        out_fpath = args.output if (args.output != None) else os.path.splitext(args.snapshot)[0] + ".popb"
+        to_binary(parse_text(args.snapshot, like.kind), like, update, out_fpath)
+        like.close()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,199 @@
+"""
+scaling_benchmark.py
+
+End-to-end (macro) benchmark: runs MAPE_EXP for a fixed number of generations over a grid of
+representations (SignalGP/ScopeGP), POP_SIZE, EVAL_TIME, EVAL_TRIAL_CNT, EVAL_THREADS, and problems
+(logic tasks, changing environment, and the shipped configs/testcases files), and reports how the system
+scales as a single .csv file (one row per run):
+ - generations/sec and evaluations/sec (from the per-phase timing each run writes with PHASE_TIMING)
+ - wall-clock time of the whole process (including setup) and its peak RSS
+ - time spent in each phase of an update (evaluation, selection, update)
+
+Every run happens in its own directory (under -work_dir) holding a copy of the configuration file, so
+runs don't trample each other's output. Snapshots and checkpoints are turned off unless overridden with -set.
+
+Example (from the experiment directory, after 'make native'):
+    python3 scripts/scaling_benchmark.py -pop_sizes 100 1000 -eval_threads 1 2 4 -out scaling.csv
+
+"""
+
+import argparse, os, sys, csv, errno, shutil, subprocess, time, itertools
+
+REPRESENTATIONS = {"signalgp": 0, "scopegp": 1}
+PROBLEM_TYPES = {"chgenv": 0, "testcases": 1, "logic": 2}
+PHASES = ["evaluation", "selection", "update"]
+NEVER = 1000000000  # Interval that never comes up during a benchmark run.
+
+
+def mkdir_p(path):
+    """
+    This is functionally equivalent to the mkdir -p [fname] bash command
+    """
+    try:
+        os.makedirs(path)
+    except OSError as exc: # Python >2.5
+        if exc.errno == errno.EEXIST and os.path.isdir(path):
+            pass
+        else: raise
+
+def read_config(fpath):
+    """
+    Read 'set NAME VALUE' lines from an Empirical configuration file (into a dictionary of strings).
+    """
+    settings = {}
+    with open(fpath, "r") as fp:
+        for line in fp:
+            line = line.split("#")[0].split()
+            if len(line) >= 3 and line[0] == "set": settings[line[1]] = line[2]
+    return settings
+
+def is_number(field):
+    try:
+        float(field)
+        return True
+    except ValueError:
+        return False
+
+def read_testcases(fpath):
+    """
+    Return the number of test cases in fpath (counted like TestcaseSet does: skip the header, blank lines, and
+    label lines, i.e. lines where no field is a number).
+    """
+    with open(fpath, "r") as fp:
+        rows = [line.strip() for line in fp][1:]
+    return sum(1 for row in rows if row and any(is_number(field) for field in row.split(",")))
+
+def read_phase_timing(fpath, warmup):
+    """
+    Sum up phase_timing.csv (skipping the first warmup updates). Returns (generations, evals, {column: seconds}).
+    """
+    gens, evals = 0, 0
+    secs = {}
+    with open(fpath, "r") as fp:
+        for i, row in enumerate(csv.DictReader(fp)):
+            if i < warmup: continue
+            gens += 1
+            evals += int(row["evals"])
+            for key in row:
+                if key.endswith("_sec"): secs[key] = secs.get(key, 0.0) + float(row[key])
+    return gens, evals, secs
+
+def run(cmd, run_dir):
+    """
+    Run cmd in run_dir (output goes to run_dir/run.log). Returns (return code, wall-clock seconds, peak RSS in KiB).
+    """
+    with open(os.path.join(run_dir, "run.log"), "w") as log:
+        start = time.time()
+        proc = subprocess.Popen(cmd, cwd=run_dir, stdout=log, stderr=subprocess.STDOUT)
+        _, status, usage = os.wait4(proc.pid, 0)
+        wall = time.time() - start
+    code = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+    # ru_maxrss is in KiB on Linux, bytes on macOS.
+    rss = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    return code, wall, rss
+
+def main():
+    parser = argparse.ArgumentParser(description="End-to-end scaling benchmark (MAPE_EXP).")
+    parser.add_argument("-exe", type=str, default="./MAPE_EXP", help="MAPE_EXP executable. Default = './MAPE_EXP'")
+    parser.add_argument("-config", type=str, default="configs/MapElitesGPConfig.cfg", help="Base configuration file. Default = 'configs/MapElitesGPConfig.cfg'")
+    parser.add_argument("-testcases_dir", type=str, default="configs/testcases", help="Directory of test case files. Default = 'configs/testcases'")
+    parser.add_argument("-work_dir", type=str, default="./scaling_runs", help="Directory to do runs in. Default = './scaling_runs'")
+    parser.add_argument("-out", type=str, default="scaling.csv", help="Where to write results. Default = 'scaling.csv'")
+    parser.add_argument("-generations", type=int, default=50, help="Generations (GENERATIONS) per run. Default = 50")
+    parser.add_argument("-warmup", type=int, default=1, help="Leading updates to leave out of per-generation rates. Default = 1")
+    parser.add_argument("-seed", type=int, default=1, help="RANDOM_SEED for every run. Default = 1")
+    parser.add_argument("-representations", type=str, nargs="+", default=["signalgp", "scopegp"], choices=sorted(REPRESENTATIONS), help="Default = signalgp scopegp")
+    parser.add_argument("-pop_sizes", type=int, nargs="+", default=[100, 1000], help="Default = 100 1000")
+    parser.add_argument("-eval_times", type=int, nargs="+", default=[128, 512], help="Default = 128 512")
+    parser.add_argument("-trial_cnts", type=int, nargs="+", default=[1], help="EVAL_TRIAL_CNT values. Default = 1")
+    parser.add_argument("-eval_threads", type=int, nargs="+", default=[1], help="EVAL_THREADS values. Default = 1")
+    parser.add_argument("-problems", type=str, nargs="+", default=["testcases", "logic"], choices=sorted(PROBLEM_TYPES), help="Default = testcases logic (chgenv is SignalGP only)")
+    parser.add_argument("-testcases", type=str, nargs="+", help="Test case files (in -testcases_dir) to use. Default = every file MAPE_EXP can load.")
+    parser.add_argument("-set", type=str, nargs="+", default=[], metavar="NAME=VALUE", help="Extra settings for every run (e.g., -set WORLD_STRUCTURE=1 SNAPSHOT_INTERVAL=10).")
+    parser.add_argument("-dry_run", action="store_true", help="Print commands without running them.")
+
+    # Extract command line arguments.
+    args = parser.parse_args()
+    exe = os.path.abspath(args.exe)
+    base_cfg = read_config(args.config)
+    extra = [kv.split("=", 1) for kv in args.set]
+
+    # Validate input.
+    if not args.dry_run and not os.path.isfile(exe):
+        print("Unable to find executable ({}). Did you 'make native'? Exiting...".format(exe))
+        exit(-1)
+    if any(len(kv) != 2 for kv in extra):
+        print("Extra settings must look like NAME=VALUE. Exiting...")
+        exit(-1)
+
+    # Which test case files are we running (and how many test cases does each have)?
+    testcase_files = {}
+    if "testcases" in args.problems:
+        fnames = args.testcases if args.testcases else sorted(f for f in os.listdir(args.testcases_dir) if f.endswith(".csv"))
+        for fname in fnames:
+            testcase_files[fname] = read_testcases(os.path.join(args.testcases_dir, fname))
+
+    # Build the grid.
+    problems = []
+    for problem in args.problems:
+        if problem == "testcases": problems += [("testcases", fname) for fname in sorted(testcase_files)]
+        else: problems.append((problem, ""))
+    grid = [point for point in itertools.product(args.representations, args.pop_sizes, args.eval_times, args.trial_cnts, args.eval_threads, problems)
+            if not (point[0] == "scopegp" and point[5][0] == "chgenv")]
+
+    mkdir_p(args.work_dir)
+    header = ["representation", "problem", "testcases", "pop_size", "eval_time", "eval_trial_cnt", "eval_threads",
+              "generations", "return_code", "wall_sec", "peak_rss_kb", "timed_generations", "timed_sec",
+              "gens_per_sec", "evals", "evals_per_sec"]
+    header += ["{}_sec".format(phase) for phase in PHASES] + ["{}_sec_per_gen".format(phase) for phase in PHASES]
+    with open(args.out, "w") as out_fp:
+        writer = csv.DictWriter(out_fp, fieldnames=header)
+        writer.writeheader()
+        for run_id, (rep, pop_size, eval_time, trial_cnt, threads, (problem, tc_fname)) in enumerate(grid):
+            run_name = "run_{}__{}__{}{}__POP{}_TIME{}_TRIALS{}_THREADS{}".format(run_id, rep, problem,
+                        "_" + os.path.splitext(tc_fname)[0] if tc_fname else "", pop_size, eval_time, trial_cnt, threads)
+            run_dir = os.path.join(args.work_dir, run_name)
+            if os.path.isdir(run_dir): shutil.rmtree(run_dir)
+            mkdir_p(run_dir)
+            shutil.copy(args.config, os.path.join(run_dir, "MapElitesGPConfig.cfg"))
+            settings = [("RANDOM_SEED", args.seed), ("REPRESENTATION", REPRESENTATIONS[rep]),
+                        ("GENERATIONS", args.generations), ("POP_SIZE", pop_size), ("EVAL_TIME", eval_time),
+                        ("EVAL_TRIAL_CNT", trial_cnt), ("EVAL_THREADS", threads), ("PROBLEM_TYPE", PROBLEM_TYPES[problem]),
+                        ("DATA_DIRECTORY", "./output/"), ("PHASE_TIMING", 1), ("SNAPSHOT_INTERVAL", NEVER),
+                        ("CHECKPOINT_INTERVAL", 0), ("RESUME", 0)]
+            if tc_fname:
+                case_cnt = min(int(base_cfg.get("NUM_TEST_CASES", testcase_files[tc_fname])), testcase_files[tc_fname])
+                settings += [("TESTCASES_FPATH", os.path.abspath(os.path.join(args.testcases_dir, tc_fname))),
+                             ("TESTCASES_CACHE", 0), ("NUM_TEST_CASES", case_cnt)]
+            settings += extra
+            cmd = [exe]
+            for name, val in settings: cmd += ["-" + name, str(val)]
+            print("[{}/{}] {}".format(run_id + 1, len(grid), " ".join(cmd)))
+            if args.dry_run: continue
+
+            ret, wall, rss = run(cmd, run_dir)
+            result = {"representation": rep, "problem": problem, "testcases": tc_fname, "pop_size": pop_size,
+                      "eval_time": eval_time, "eval_trial_cnt": trial_cnt, "eval_threads": threads,
+                      "generations": args.generations, "return_code": ret, "wall_sec": wall, "peak_rss_kb": rss}
+            # SignalGP writes phase timing to DATA_DIRECTORY; ScopeGP writes to the working directory.
+            timing_fpath = os.path.join(run_dir, "output", "phase_timing.csv")
+            if not os.path.isfile(timing_fpath): timing_fpath = os.path.join(run_dir, "phase_timing.csv")
+            if ret != 0 or not os.path.isfile(timing_fpath):
+                print("  Run failed (return code {}); see {}".format(ret, os.path.join(run_dir, "run.log")))
+            else:
+                gens, evals, secs = read_phase_timing(timing_fpath, args.warmup)
+                timed = secs.get("total_sec", 0.0)
+                result.update({"timed_generations": gens, "timed_sec": timed, "evals": evals,
+                               "gens_per_sec": gens / timed if timed > 0 else "",
+                               "evals_per_sec": evals / timed if timed > 0 else ""})
+                for phase in PHASES:
+                    phase_secs = secs.get("{}_sec".format(phase), 0.0)
+                    result["{}_sec".format(phase)] = phase_secs
+                    result["{}_sec_per_gen".format(phase)] = phase_secs / gens if gens else ""
+                print("  {:.2f} gens/sec, {:.1f} evals/sec, peak RSS {} KiB".format(
+                      gens / timed if timed > 0 else 0, evals / timed if timed > 0 else 0, rss))
+            writer.writerow(result)
+            out_fp.flush()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,140 @@
+#ifndef MAPEGP_BENCHMARK_H
+#define MAPEGP_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "base/vector.h"
+
+/// Small microbenchmark harness (used by native/MAPE_BENCH.cc; see 'make bench').
+///  - A benchmark body is handed the number of ops to run (so per-op call overhead stays out of the measurement).
+///  - Ops per round double until a round takes at least min_time; we then time repeat_cnt rounds of that size and
+///    report the median (and fastest) time per op.
+///  - Benchmarks may report work items per op (e.g., offspring per MAP-Elites batch) to get items per second.
+///  - Results are written as JSON: {"suite": ..., "context": {...}, "benchmarks": [{...}, ...]}.
+class BenchmarkSuite {
+public:
+  using body_t = std::function<void(size_t)>;  ///< body(op_cnt): run op_cnt ops.
+
+  struct Result {
+    std::string name;
+    size_t ops_per_round;
+    size_t rounds;
+    double ns_per_op;      ///< Median across timed rounds.
+    double ns_per_op_min;  ///< Fastest timed round.
+    double items_per_op;   ///< Work items per op (0 if the benchmark doesn't count any).
+  };
+
+protected:
+  std::string suite_name;
+  double min_time;       ///< Minimum wall-clock seconds per timed round.
+  size_t repeat_cnt;     ///< Timed rounds per benchmark.
+  size_t max_ops;        ///< Never run more than this many ops in a round.
+  std::string filter;    ///< Only run benchmarks whose name contains filter.
+  emp::vector<std::pair<std::string, std::string>> context;  ///< Extra (string) information about this run.
+  emp::vector<Result> results;
+
+  static double TimeRound(const body_t & body, size_t ops) {
+    const auto start = std::chrono::steady_clock::now();
+    body(ops);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  static std::string Escape(const std::string & str) {
+    std::string out;
+    for (char c : str) {
+      if (c == '"' || c == '\\') { out += '\\'; out += c; }
+      else if ((unsigned char)c < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+        out += buf;
+      } else out += c;
+    }
+    return out;
+  }
+
+public:
+  BenchmarkSuite(const std::string & _name, double _min_time=0.25, size_t _repeat_cnt=5, size_t _max_ops=1000000000)
+    : suite_name(_name), min_time(_min_time), repeat_cnt(_repeat_cnt ? _repeat_cnt : 1), max_ops(_max_ops),
+      filter(), context(), results() { ; }
+
+  const emp::vector<Result> & GetResults() const { return results; }
+
+  void SetMinTime(double secs) { min_time = secs; }
+  void SetRepeatCnt(size_t cnt) { repeat_cnt = (cnt) ? cnt : 1; }
+  void SetFilter(const std::string & str) { filter = str; }
+
+  /// Will a benchmark with this name be run (given the filter)?
+  bool IsSelected(const std::string & name) const { return name.find(filter) != std::string::npos; }
+
+  /// Will any of these benchmarks be run? (Lets callers skip expensive setup.)
+  bool IsAnySelected(const emp::vector<std::string> & names) const {
+    for (const std::string & name : names) if (IsSelected(name)) return true;
+    return false;
+  }
+
+  /// Record extra information about this run (written to the "context" object).
+  void AddContext(const std::string & key, const std::string & val) { context.emplace_back(key, val); }
+
+  /// Run (and record) benchmark name, if selected. Returns the result (nullptr if filtered out), so callers can
+  /// fill out items_per_op once they know it.
+  Result * Run(const std::string & name, const body_t & body, double items_per_op=0) {
+    if (!IsSelected(name)) return nullptr;
+    // Calibrate (also warms up caches, lazily allocated scratch space, etc.).
+    size_t ops = 1;
+    double secs = TimeRound(body, ops);
+    while (secs < min_time && ops < max_ops) {
+      ops = std::min(max_ops, ops * 2);
+      secs = TimeRound(body, ops);
+    }
+    emp::vector<double> times(repeat_cnt);
+    for (size_t i = 0; i < repeat_cnt; ++i) times[i] = TimeRound(body, ops);
+    std::sort(times.begin(), times.end());
+    const double median = (repeat_cnt % 2) ? times[repeat_cnt / 2] : (times[repeat_cnt/2 - 1] + times[repeat_cnt/2]) / 2;
+    results.push_back({name, ops, repeat_cnt, 1e9 * median / ops, 1e9 * times[0] / ops, items_per_op});
+    std::cout << std::left << std::setw(56) << name << std::right << std::setw(16) << std::fixed << std::setprecision(1)
+              << results.back().ns_per_op << " ns/op  (" << ops << " ops x " << repeat_cnt << ")" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    return &results.back();
+  }
+
+  /// Write results (as JSON) to fpath. Returns false on failure.
+  bool Write(const std::string & fpath) const {
+    std::ofstream ofs(fpath);
+    if (!ofs.is_open()) return false;
+    const std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    ofs << std::setprecision(10);
+    ofs << "{\n  \"suite\": \"" << Escape(suite_name) << "\",\n";
+    ofs << "  \"context\": {\n    \"date\": \"" << date << "\",\n";
+    ofs << "    \"min_time_sec\": " << min_time << ",\n    \"repeats\": " << repeat_cnt;
+    for (const auto & kv : context) ofs << ",\n    \"" << Escape(kv.first) << "\": \"" << Escape(kv.second) << "\"";
+    ofs << "\n  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const Result & res = results[i];
+      ofs << ((i) ? ",\n" : "\n") << "    {\"name\": \"" << Escape(res.name) << "\""
+          << ", \"ops_per_round\": " << res.ops_per_round << ", \"rounds\": " << res.rounds
+          << ", \"ns_per_op\": " << res.ns_per_op << ", \"ns_per_op_min\": " << res.ns_per_op_min
+          << ", \"ops_per_sec\": " << ((res.ns_per_op > 0) ? 1e9 / res.ns_per_op : 0.0);
+      if (res.items_per_op > 0) {
+        ofs << ", \"items_per_op\": " << res.items_per_op
+            << ", \"items_per_sec\": " << ((res.ns_per_op > 0) ? 1e9 * res.items_per_op / res.ns_per_op : 0.0);
+      }
+      ofs << "}";
+    }
+    ofs << "\n  ]\n}\n";
+    ofs.close();
+    return (bool)ofs;
+  }
+};
+
+#endif
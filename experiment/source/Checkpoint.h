@@ -0,0 +1,262 @@
+#ifndef MAPEGP_CHECKPOINT_H
+#define MAPEGP_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#ifndef EMSCRIPTEN
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "base/Ptr.h"
+#include "base/assert.h"
+#include "base/vector.h"
+#include "data/DataFile.h"
+
+/// Checkpoint files let a killed run pick up exactly where it left off.
+///  - A checkpoint is a single binary file: magic, version, world kind, then whatever the world Puts (in order).
+///  - Save is atomic: we write to [path].tmp, fsync, and rename over [path], so a kill mid-write leaves the
+///    previous checkpoint intact.
+///  - Worlds are responsible for making their random number streams restartable (e.g., reseeding the world
+///    random number generator every update; see RandomStreams.h).
+constexpr char CHECKPOINT_MAGIC[8] = {'M','A','P','E','C','K','P','T'};
+constexpr uint32_t CHECKPOINT_VERSION = 2;
+
+enum class CHECKPOINT_KIND : uint32_t { SIGNALGP=0, SCOPEGP=1 };
+
+/// Build up a checkpoint in memory, then save it (atomically).
+class CheckpointWriter {
+protected:
+  emp::vector<unsigned char> buffer;
+
+public:
+  CheckpointWriter(CHECKPOINT_KIND kind) : buffer() {
+    buffer.insert(buffer.end(), CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + sizeof(CHECKPOINT_MAGIC));
+    Put(CHECKPOINT_VERSION);
+    Put((uint32_t)kind);
+  }
+
+  /// Append a trivially copyable value.
+  template <typename T>
+  void Put(const T & val) {
+    const size_t pos = buffer.size();
+    buffer.resize(pos + sizeof(T));
+    std::memcpy(&buffer[pos], &val, sizeof(T));
+  }
+
+  void PutString(const std::string & str) {
+    Put((uint64_t)str.size());
+    buffer.insert(buffer.end(), str.begin(), str.end());
+  }
+
+  /// Append a vector of trivially copyable values.
+  template <typename T>
+  void PutVector(const emp::vector<T> & vals) {
+    Put((uint64_t)vals.size());
+    if (vals.size() == 0) return;
+    const size_t pos = buffer.size();
+    buffer.resize(pos + vals.size() * sizeof(T));
+    std::memcpy(&buffer[pos], vals.data(), vals.size() * sizeof(T));
+  }
+
+  void PutVector(const emp::vector<bool> & vals) {
+    Put((uint64_t)vals.size());
+    for (bool val : vals) Put((uint8_t)val);
+  }
+
+  /// Write checkpoint to fpath, replacing any previous checkpoint only once the new one is safely on disk.
+  /// Returns false on failure (in which case any previous checkpoint is left untouched).
+  bool Save(const std::string & fpath) const {
+    const std::string tmp_fpath = fpath + ".tmp";
+    #ifndef EMSCRIPTEN
+    int fd = ::open(tmp_fpath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    size_t written = 0;
+    while (written < buffer.size()) {
+      const ssize_t cnt = ::write(fd, buffer.data() + written, buffer.size() - written);
+      if (cnt <= 0) { ::close(fd); std::remove(tmp_fpath.c_str()); return false; }
+      written += (size_t)cnt;
+    }
+    if (::fsync(fd) != 0) { ::close(fd); std::remove(tmp_fpath.c_str()); return false; }
+    ::close(fd);
+    if (std::rename(tmp_fpath.c_str(), fpath.c_str()) != 0) return false;
+    // Make the rename itself durable.
+    const size_t slash = fpath.find_last_of('/');
+    const std::string dir = (slash == std::string::npos) ? "." : fpath.substr(0, slash + 1);
+    int dir_fd = ::open(dir.c_str(), O_RDONLY);
+    if (dir_fd >= 0) { ::fsync(dir_fd); ::close(dir_fd); }
+    return true;
+    #else
+    std::ofstream ofs(tmp_fpath, std::ios::binary | std::ios::trunc);
+    ofs.write((const char *)buffer.data(), (std::streamsize)buffer.size());
+    ofs.close();
+    if (!ofs) return false;
+    return std::rename(tmp_fpath.c_str(), fpath.c_str()) == 0;
+    #endif
+  }
+};
+
+/// Read back a checkpoint in the same order it was written.
+/// Reads past the end (or of the wrong kind) flag the reader as failed rather than crashing.
+class CheckpointReader {
+protected:
+  emp::vector<unsigned char> buffer;
+  size_t pos;
+  bool ok;
+
+  bool Take(void * out, size_t bytes) {
+    if (!ok || pos + bytes > buffer.size()) { ok = false; return false; }
+    std::memcpy(out, buffer.data() + pos, bytes);
+    pos += bytes;
+    return true;
+  }
+
+public:
+  CheckpointReader() : buffer(), pos(0), ok(false) { ; }
+
+  /// Is everything we've read so far valid?
+  bool IsOK() const { return ok; }
+
+  /// Load checkpoint from fpath. Returns false if file is missing, malformed, or of another kind.
+  bool Load(const std::string & fpath, CHECKPOINT_KIND kind) {
+    std::ifstream ifs(fpath, std::ios::binary);
+    if (!ifs.is_open()) { ok = false; return false; }
+    buffer.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    pos = 0;
+    ok = true;
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    if (!Take(magic, sizeof(magic)) || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) ok = false;
+    if (Get<uint32_t>() != CHECKPOINT_VERSION) ok = false;
+    if (Get<uint32_t>() != (uint32_t)kind) ok = false;
+    return ok;
+  }
+
+  template <typename T>
+  T Get() {
+    T val = T();
+    Take(&val, sizeof(T));
+    return val;
+  }
+
+  std::string GetString() {
+    const uint64_t len = Get<uint64_t>();
+    if (!ok || pos + len > buffer.size()) { ok = false; return ""; }
+    std::string str((const char *)buffer.data() + pos, len);
+    pos += len;
+    return str;
+  }
+
+  template <typename T>
+  void GetVector(emp::vector<T> & vals) {
+    const uint64_t cnt = Get<uint64_t>();
+    if (!ok || pos + cnt * sizeof(T) > buffer.size()) { ok = false; return; }
+    vals.resize(cnt);
+    if (cnt) Take(vals.data(), cnt * sizeof(T));
+  }
+
+  void GetVector(emp::vector<bool> & vals) {
+    const uint64_t cnt = Get<uint64_t>();
+    if (!ok || pos + cnt > buffer.size()) { ok = false; return; }
+    vals.resize(cnt);
+    for (size_t i = 0; i < cnt; ++i) vals[i] = Get<uint8_t>();
+  }
+};
+
+/// Output stream opened for a CheckpointDataFile (base-from-member, so the stream outlives the DataFile using it).
+struct CheckpointStream {
+  std::ofstream stream;
+  CheckpointStream(const std::string & fpath, std::ios::openmode mode) : stream(fpath, mode) { ; }
+};
+
+/// Data file that owns its output stream (so it can be handed off to a World via AddDataFile).
+template <typename DATAFILE_T=emp::DataFile>
+class CheckpointDataFile : protected CheckpointStream, public DATAFILE_T {
+public:
+  CheckpointDataFile(const std::string & fpath, std::ios::openmode mode)
+    : CheckpointStream(fpath, mode), DATAFILE_T(CheckpointStream::stream) { ; }
+
+  std::ofstream & GetCheckpointStream() { return CheckpointStream::stream; }
+};
+
+/// Output files that need to survive a checkpoint/restart.
+///  - Checkpoints record how long each file was; on resume, each file is cut back to that length and
+///    appended to (so rows written after the checkpoint, before the kill, are not duplicated).
+///  - Streams are owned by whoever opened them (e.g., the World owns data files added via AddDataFile).
+class CheckpointFiles {
+protected:
+  struct File {
+    std::string fpath;
+    std::ostream * os;
+  };
+  emp::vector<File> files;
+  std::unordered_map<std::string, uint64_t> resume_lengths;  ///< Checkpointed file lengths (when resuming).
+
+  /// Get open mode for fpath, truncating it to its checkpointed length if we're resuming.
+  std::ios::openmode Prepare(const std::string & fpath) {
+    if (!IsResuming(fpath)) return std::ios::out | std::ios::trunc;
+    #ifndef EMSCRIPTEN
+    if (::truncate(fpath.c_str(), (off_t)resume_lengths[fpath]) != 0) {
+      std::cout << "Failed to restore " << fpath << " from checkpoint. Exiting..." << std::endl;
+      exit(-1);
+    }
+    #endif
+    return std::ios::out | std::ios::app;
+  }
+
+public:
+  CheckpointFiles() : files(), resume_lengths() { ; }
+
+  /// Will fpath pick up where a checkpointed run left off? (If so, don't print headers again.)
+  bool IsResuming(const std::string & fpath) const { return resume_lengths.count(fpath) > 0; }
+
+  /// Open (and track) os for fpath; os must outlive this object (or at least any further calls to Save).
+  void Open(std::ofstream & os, const std::string & fpath) {
+    os.open(fpath, Prepare(fpath));
+    files.push_back({fpath, &os});
+  }
+
+  /// Open (and track) a data file for fpath; caller owns it (e.g., pass it to World::AddDataFile).
+  template <typename DATAFILE_T=emp::DataFile>
+  emp::Ptr<CheckpointDataFile<DATAFILE_T>> OpenDataFile(const std::string & fpath) {
+    const std::ios::openmode mode = Prepare(fpath);
+    auto file = emp::NewPtr<CheckpointDataFile<DATAFILE_T>>(fpath, mode);
+    files.push_back({fpath, &(file->GetCheckpointStream())});
+    return file;
+  }
+
+  /// Record current length of every file (flushing them first).
+  void Save(CheckpointWriter & ckpt) const {
+    ckpt.Put((uint64_t)files.size());
+    for (const File & file : files) {
+      file.os->flush();
+      uint64_t len = 0;
+      #ifndef EMSCRIPTEN
+      struct stat st;
+      if (stat(file.fpath.c_str(), &st) == 0) len = (uint64_t)st.st_size;
+      #endif
+      ckpt.PutString(file.fpath);
+      ckpt.Put(len);
+    }
+  }
+
+  /// Restore checkpointed file lengths. Must happen before files are opened.
+  void Load(CheckpointReader & ckpt) {
+    const uint64_t cnt = ckpt.Get<uint64_t>();
+    for (size_t i = 0; i < cnt && ckpt.IsOK(); ++i) {
+      std::string fpath = ckpt.GetString();
+      resume_lengths[fpath] = ckpt.Get<uint64_t>();
+    }
+  }
+};
+
+#endif
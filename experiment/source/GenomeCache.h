@@ -0,0 +1,99 @@
+#ifndef MAPEGP_GENOME_CACHE_H
+#define MAPEGP_GENOME_CACHE_H
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "base/assert.h"
+
+/// Utility class used to memoize evaluation results by genome (across generations).
+///  - Keyed by genome hash (GENOME_T::Hash()); stored genome copies guard against hash collisions.
+///  - Bounded: once full, the least recently used entry is evicted.
+///  - Only makes sense when evaluation is deterministic given the genome.
+template <typename GENOME_T, typename VALUE_T>
+class GenomeCache {
+public:
+  using genome_t = GENOME_T;
+  using value_t = VALUE_T;
+
+protected:
+  struct Entry {
+    size_t hash;
+    genome_t genome;
+    value_t value;
+
+    Entry(size_t _h, const genome_t & _g, const value_t & _v) : hash(_h), genome(_g), value(_v) { ; }
+  };
+  using entry_list_t = std::list<Entry>;
+
+  size_t capacity;    ///< Max number of entries (0 => cache disabled).
+  entry_list_t lru;   ///< Entries, from most to least recently used.
+  std::unordered_map<size_t, typename entry_list_t::iterator> lookup;
+
+  size_t hit_cnt;     ///< Hits since last ResetStats.
+  size_t miss_cnt;    ///< Misses since last ResetStats.
+
+public:
+  GenomeCache(size_t _capacity=0)
+    : capacity(_capacity), lru(), lookup(), hit_cnt(0), miss_cnt(0) { ; }
+
+  /// Is this cache turned on?
+  bool IsActive() const { return capacity > 0; }
+  size_t GetCapacity() const { return capacity; }
+  size_t GetSize() const { return lru.size(); }
+  size_t GetHitCnt() const { return hit_cnt; }
+  size_t GetMissCnt() const { return miss_cnt; }
+
+  /// Change the capacity of the cache (evicting entries if necessary).
+  void SetCapacity(size_t _capacity) {
+    capacity = _capacity;
+    while (lru.size() > capacity) Evict();
+  }
+
+  void ResetStats() { hit_cnt = 0; miss_cnt = 0; }
+
+  /// Count a lookup that was answered without the cache (e.g., by an identical genome evaluated in the same pass).
+  void CountHit() { ++hit_cnt; }
+
+  void Clear() { lru.clear(); lookup.clear(); }
+
+  /// Find cached value for given genome (with precomputed hash). Returns nullptr on a miss.
+  /// Counts toward hit/miss statistics and refreshes the entry's recency.
+  const value_t * Find(const genome_t & genome, size_t hash) {
+    if (!IsActive()) return nullptr;
+    auto it = lookup.find(hash);
+    if (it == lookup.end() || it->second->genome != genome) { ++miss_cnt; return nullptr; }
+    ++hit_cnt;
+    lru.splice(lru.begin(), lru, it->second);
+    return &(it->second->value);
+  }
+
+  const value_t * Find(const genome_t & genome) { return Find(genome, genome.Hash()); }
+
+  /// Cache value for given genome (with precomputed hash).
+  /// If another genome with the same hash is cached, it gets replaced.
+  void Insert(const genome_t & genome, size_t hash, const value_t & value) {
+    if (!IsActive()) return;
+    auto it = lookup.find(hash);
+    if (it != lookup.end()) {
+      lru.erase(it->second);
+      lookup.erase(it);
+    }
+    if (lru.size() >= capacity) Evict();
+    lru.emplace_front(hash, genome, value);
+    lookup[hash] = lru.begin();
+  }
+
+  void Insert(const genome_t & genome, const value_t & value) { Insert(genome, genome.Hash(), value); }
+
+protected:
+  /// Remove least recently used entry.
+  void Evict() {
+    emp_assert(lru.size());
+    lookup.erase(lru.back().hash);
+    lru.pop_back();
+  }
+};
+
+#endif
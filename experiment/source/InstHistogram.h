@@ -0,0 +1,65 @@
+#ifndef MAPEGP_INST_HISTOGRAM_H
+#define MAPEGP_INST_HISTOGRAM_H
+
+#include <cmath>
+
+#include "base/assert.h"
+#include "base/vector.h"
+
+/// How many times each instruction (by ID) appears in a program.
+///  - Sized for the whole instruction set up front (Reset), so adding and removing instructions never allocates.
+///  - Kept up to date through mutations (see ProgramMutator: only functions a mutation changed get recounted), so
+///    instruction count and entropy never need a full recount.
+class InstHistogram {
+protected:
+  emp::vector<size_t> counts;  ///< counts[inst_id]
+  size_t total;                ///< Sum of counts (i.e., program length).
+
+public:
+  InstHistogram() : counts(), total(0) { ; }
+
+  size_t GetTotal() const { return total; }
+  size_t GetInstLibSize() const { return counts.size(); }
+  size_t GetCount(size_t inst_id) const { emp_assert(inst_id < counts.size()); return counts[inst_id]; }
+
+  /// Clear all counts, sizing the histogram for an instruction set with inst_lib_size instructions.
+  void Reset(size_t inst_lib_size) {
+    counts.assign(inst_lib_size, 0);
+    total = 0;
+  }
+
+  void Add(size_t inst_id) {
+    emp_assert(inst_id < counts.size(), inst_id, counts.size());
+    ++counts[inst_id];
+    ++total;
+  }
+
+  void Remove(size_t inst_id) {
+    emp_assert(inst_id < counts.size() && counts[inst_id] > 0, inst_id, counts.size());
+    --counts[inst_id];
+    --total;
+  }
+
+  /// Add (or remove) every instruction in fun (a SignalGP function).
+  template <typename FUNCTION_T>
+  void AddFunction(const FUNCTION_T & fun) { for (size_t i = 0; i < fun.GetSize(); ++i) Add(fun[i].id); }
+  template <typename FUNCTION_T>
+  void RemoveFunction(const FUNCTION_T & fun) { for (size_t i = 0; i < fun.GetSize(); ++i) Remove(fun[i].id); }
+
+  /// Shannon entropy (in bits) of the instruction distribution; O(instruction set size).
+  double GetEntropy() const {
+    if (total == 0) return 0.0;
+    double entropy = 0.0;
+    for (size_t count : counts) {
+      if (count == 0) continue;
+      const double p = count / (double)total;
+      entropy -= p * std::log2(p);
+    }
+    return (entropy > 0.0) ? entropy : 0.0;
+  }
+
+  bool operator==(const InstHistogram & in) const { return total == in.total && counts == in.counts; }
+  bool operator!=(const InstHistogram & in) const { return !(*this == in); }
+};
+
+#endif
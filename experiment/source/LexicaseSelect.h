@@ -0,0 +1,186 @@
+#ifndef MAPEGP_LEXICASE_SELECT_H
+#define MAPEGP_LEXICASE_SELECT_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "base/assert.h"
+#include "base/vector.h"
+#include "tools/Random.h"
+
+#include "RandomStreams.h"
+#include "WorkerPool.h"
+
+/// Flat (case-major) matrix of lexicase scores: one row per fitness case, one column per organism.
+///  - Filled once per generation; lexicase selection then only ever reads contiguous rows of doubles.
+///  - Higher scores are better. Empty world positions should get GetEmptyScore() (they never beat a real org), and so
+///    should results that aren't finite numbers (see ToScore): NaNs don't order against anything.
+class ScoreMatrix {
+protected:
+  size_t case_cnt;
+  size_t org_cnt;
+  emp::vector<double> scores;  ///< scores[case_id * org_cnt + org_id]
+
+public:
+  ScoreMatrix() : case_cnt(0), org_cnt(0), scores() { ; }
+
+  static constexpr double GetEmptyScore() { return std::numeric_limits<double>::lowest(); }
+
+  /// Score for a fitness case result (non-finite results get the empty score).
+  static double ToScore(double result) { return (std::isfinite(result)) ? result : GetEmptyScore(); }
+
+  size_t GetCaseCnt() const { return case_cnt; }
+  size_t GetOrgCnt() const { return org_cnt; }
+
+  /// Resize matrix (only allocates when it grows).
+  void Resize(size_t _case_cnt, size_t _org_cnt) {
+    case_cnt = _case_cnt;
+    org_cnt = _org_cnt;
+    scores.resize(case_cnt * org_cnt);
+  }
+
+  double * GetCase(size_t case_id) {
+    emp_assert(case_id < case_cnt, case_id, case_cnt);
+    return scores.data() + case_id * org_cnt;
+  }
+  const double * GetCase(size_t case_id) const {
+    emp_assert(case_id < case_cnt, case_id, case_cnt);
+    return scores.data() + case_id * org_cnt;
+  }
+
+  double & Get(size_t case_id, size_t org_id) {
+    emp_assert(org_id < org_cnt, org_id, org_cnt);
+    return GetCase(case_id)[org_id];
+  }
+  double Get(size_t case_id, size_t org_id) const {
+    emp_assert(org_id < org_cnt, org_id, org_cnt);
+    return GetCase(case_id)[org_id];
+  }
+};
+
+/// Lexicase selection over a ScoreMatrix.
+///  - Same semantics as emp::LexicaseSelect: for each selection, walk cases in a fresh random order, keeping only
+///    candidates tied for best on each, until one candidate is left (or we run out of cases); break remaining ties
+///    at random.
+///  - Case orderings are drawn lazily (one step of a Fisher-Yates shuffle per case actually used).
+///  - Filtering is two flat passes per case (max, then branch-free compaction); scratch space is reused, so
+///    selection does not allocate once warmed up.
+class LexicaseSelector {
+protected:
+  emp::vector<size_t> case_order;
+  emp::vector<size_t> candidates;
+  emp::vector<size_t> next_candidates;
+
+  /// Keep candidates (cnt of them, in cands) tied for best on row; returns new count (written to out).
+  /// If nothing ties for best (row has NaNs), every candidate is kept.
+  static size_t Filter(const double * row, const size_t * cands, size_t cnt, size_t * out) {
+    double best = row[cands[0]];
+    for (size_t i = 1; i < cnt; ++i) best = std::max(best, row[cands[i]]);
+    size_t kept = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+      out[kept] = cands[i];
+      kept += (row[cands[i]] == best);
+    }
+    if (kept == 0) {
+      std::copy(cands, cands + cnt, out);
+      return cnt;
+    }
+    return kept;
+  }
+
+  /// Filter on a full row (every org is a candidate): contiguous loads only.
+  static size_t FilterAll(const double * row, size_t cnt, size_t * out) {
+    double best = row[0];
+    for (size_t i = 1; i < cnt; ++i) best = std::max(best, row[i]);
+    size_t kept = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+      out[kept] = i;
+      kept += (row[i] == best);
+    }
+    if (kept == 0) {
+      for (size_t i = 0; i < cnt; ++i) out[i] = i;
+      return cnt;
+    }
+    return kept;
+  }
+
+public:
+  LexicaseSelector() : case_order(), candidates(), next_candidates() { ; }
+
+  /// Forget case ordering left over from previous selections (so the next selections only depend on the random
+  /// number stream they're given).
+  void ResetCaseOrder() {
+    for (size_t i = 0; i < case_order.size(); ++i) case_order[i] = i;
+  }
+
+  /// Select a single organism (column of scores).
+  size_t Select(const ScoreMatrix & scores, emp::Random & rnd) {
+    const size_t case_cnt = scores.GetCaseCnt();
+    const size_t org_cnt = scores.GetOrgCnt();
+    emp_assert(org_cnt > 0);
+    if (case_order.size() != case_cnt) {
+      case_order.resize(case_cnt);
+      for (size_t i = 0; i < case_cnt; ++i) case_order[i] = i;
+    }
+    candidates.resize(org_cnt);
+    next_candidates.resize(org_cnt);
+    size_t cnt = org_cnt;
+    for (size_t depth = 0; depth < case_cnt && cnt > 1; ++depth) {
+      std::swap(case_order[depth], case_order[rnd.GetUInt(depth, case_cnt)]);
+      const double * row = scores.GetCase(case_order[depth]);
+      if (cnt == org_cnt) {
+        cnt = FilterAll(row, org_cnt, next_candidates.data());
+      } else {
+        cnt = Filter(row, candidates.data(), cnt, next_candidates.data());
+      }
+      std::swap(candidates, next_candidates);
+    }
+    if (cnt == org_cnt) return rnd.GetUInt(org_cnt);  // Everyone is still tied (or there was nothing to filter on).
+    return (cnt == 1) ? candidates[0] : candidates[rnd.GetUInt(cnt)];
+  }
+
+  /// Select cnt organisms (with replacement), writing them to winners.
+  void Select(const ScoreMatrix & scores, emp::Random & rnd, size_t cnt, emp::vector<size_t> & winners) {
+    winners.resize(cnt);
+    for (size_t i = 0; i < cnt; ++i) winners[i] = Select(scores, rnd);
+  }
+};
+
+/// Lexicase selection events spread across a WorkerPool.
+///  - Events are split into fixed-size blocks; each block gets its own random number stream (named by seed and
+///    block ID; see RandomStreams.h), so winners depend only on seed, never on worker count or scheduling.
+///  - Each worker keeps its own selector scratch space and random number generator.
+class ParallelLexicaseSelector {
+protected:
+  size_t block_size;                       ///< Selection events per block (i.e., per random number stream).
+  emp::vector<LexicaseSelector> selectors; ///< One per worker.
+  emp::vector<emp::Random> rnds;           ///< One per worker (reseeded for every block).
+
+public:
+  ParallelLexicaseSelector(size_t _block_size=16)
+    : block_size(_block_size ? _block_size : 1), selectors(), rnds() { ; }
+
+  size_t GetBlockSize() const { return block_size; }
+
+  /// Select cnt organisms (with replacement), writing them to winners (in event order).
+  void Select(const ScoreMatrix & scores, WorkerPool & pool, uint64_t seed, size_t cnt, emp::vector<size_t> & winners) {
+    while (selectors.size() < pool.GetSize()) {
+      selectors.emplace_back();
+      rnds.emplace_back(1);
+    }
+    winners.resize(cnt);
+    const size_t block_cnt = (cnt + block_size - 1) / block_size;
+    pool.Run(block_cnt, [this, &scores, &winners, seed, cnt](size_t worker_id, size_t block_id) {
+      LexicaseSelector & selector = selectors[worker_id];
+      emp::Random & rnd = rnds[worker_id];
+      rnd.ResetSeed(DeriveStreamSeed(seed, {(uint64_t)block_id}));
+      selector.ResetCaseOrder();
+      const size_t end = std::min(cnt, (block_id + 1) * block_size);
+      for (size_t i = block_id * block_size; i < end; ++i) winners[i] = selector.Select(scores, rnd);
+    });
+  }
+};
+
+#endif
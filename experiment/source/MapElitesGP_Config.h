@@ -17,6 +17,10 @@ EMP_BUILD_CONFIG( MapElitesGPConfig,
   VALUE(EVAL_TRIAL_CNT, size_t, 3, "How many independent trials should we evaluate each program for when calculating fitness?"),
   VALUE(EVAL_TRIAL_AGG_METHOD, size_t, 0, "What method should we use to aggregate scores (to determine actual fitness) across fitness evaluation trials? \n0: Fitness = Min trial score \n1: Fitness = Max trial score \n2: Fitness = Avg trial score"),
   VALUE(EVAL_TIME, size_t, 256, "How many time steps should we evaluate organisms during each evaluation trial?"),
+  VALUE(EVAL_THREADS, size_t, 1, "How many worker threads should we use to evaluate the population (and run SignalGP lexicase selection)? Each worker gets its own evaluation hardware and state. \n1: Evaluate serially on the main thread"),
+  VALUE(GENOME_CACHE_SIZE, size_t, 0, "How many genomes' evaluation results should we remember across generations (SignalGP only)? Only used when evaluation is deterministic (testcase problem without test case shuffling). \n0: Do not cache evaluations"),
+  VALUE(EVAL_EARLY_EXIT, bool, false, "Should evaluations stop early once their outcome is settled (testcases: no threads left running, or output is final under FIRST_SUBMIT_WINS; logic: all tasks credited)?"),
+  VALUE(FIRST_SUBMIT_WINS, bool, false, "Is the first output a program submits for a testcase final (later submissions are ignored)?"),
 
   GROUP(EA_SELECTION, "Settings used to specify how selection should happen."),
   VALUE(SELECTION_METHOD, size_t, 0, "Which selection scheme should we use to select organisms to reproduce (asexually)? Note: this is only relevant when running in EA mode. \n0: Tournament \n1: Lexicase \n2: Random "),
@@ -32,10 +36,12 @@ EMP_BUILD_CONFIG( MapElitesGPConfig,
   VALUE(USE_MAPE_AXIS__FUNC_ENTERED, bool, false, "Should we use number of functions entered (repeats are counted) as a MAP-Elites axis?"),
   VALUE(USE_MAPE_AXIS__FUNC_ENTERED_ENTROPY, bool, false, "Should we use entropy of number of functions entered as a MAP-Elites axis?"),
   VALUE(MAPE_AXIS_SIZE__FUNC_ENTERED_ENTROPY, size_t, 20, "Width (in map grid cells) of the functions entered entropy MAPE axis?"),
+  VALUE(MAPE_BATCH_SIZE, size_t, 0, "How many offspring should MAP-Elites breed (and evaluate, across EVAL_THREADS workers) before placing them in the map (SignalGP only)? Offspring in a batch are all bred from the map as it was before the batch. \n0: Place each offspring as soon as it's evaluated"),
 
   GROUP(PROBLEM, "Settings related to the problem we're evolving programs to solve."),
   VALUE(PROBLEM_TYPE, size_t, 0, "What problem are we solving? \n0: Changing environment problem \n1: Testcase problem (requires TESTCASES_FPATH setting) \n2: Logic tasks problem"),
   VALUE(TESTCASES_FPATH, std::string, "testcases/examples-squares.csv", "Where is the file containing testcases for the problem we're solving?"),
+  VALUE(TESTCASES_CACHE, bool, false, "Should we cache parsed testcases in a binary file (TESTCASES_FPATH.bin) so later runs can skip parsing?"),
 
   GROUP(CHG_ENV_PROBLEM, "Settings specific to the changing environment problem"),
   VALUE(ENV_TAG_GEN_METHOD, size_t, 0, "How should we generate environment tags (true and distraction)? \n0: Randomly\n1: Load from file (ENV_TAG_FPATH)"),
@@ -52,6 +58,10 @@ EMP_BUILD_CONFIG( MapElitesGPConfig,
   GROUP(TESTCASES_PROBLEM, "Settings specific to test case problems."),
   VALUE(NUM_TEST_CASES, size_t, 10, "How many test cases should we use when evaluating an organism?"), 
   VALUE(SHUFFLE_TEST_CASES, bool, false, "Should we shuffle test cases used to evaluate agents every generation? "),
+  VALUE(TESTCASE_SAMPLING, size_t, 0, "How should we pick the NUM_TEST_CASES test cases used each generation? \n0: Fixed (first NUM_TEST_CASES; reshuffled every generation if SHUFFLE_TEST_CASES) \n1: Down-sampled (fresh random subset every generation) \n2: Rotating (next NUM_TEST_CASES of a shuffled ordering every generation) \n3: Stratified (one random test case from each of NUM_TEST_CASES output-sorted strata every generation)"),
+
+  GROUP(LOGIC_PROBLEM, "Settings specific to the logic tasks problem."),
+  VALUE(LOGIC_INPUT_POOL_SIZE, size_t, 0, "How many collision-free logic task inputs should we generate up front (and sample from every trial)? 0: Draw fresh inputs every trial"),
 
   GROUP(PROGRAM_CONSTRAINTS, "SignalGP program constraits that mutation operators/initialization will respect."),
   VALUE(PROG_MIN_FUNC_CNT, size_t, 1, "Minimum number of functions mutations are allowed to reduce a SignalGP program to."),
@@ -86,6 +96,11 @@ EMP_BUILD_CONFIG( MapElitesGPConfig,
   VALUE(SNAPSHOT_INTERVAL, size_t, 1000, "How often should we take a population snapshot?"),
   VALUE(DOM_SNAPSHOT_TRIAL_CNT, size_t, 100, "How many trials should we do in dominant snapshot?"),
   VALUE(MAP_SNAPSHOT_TRIAL_CNT, size_t, 10, "How many trials should we do in a map snapshot?"),
+  VALUE(POP_SNAPSHOT_FORMAT, size_t, 0, "What format should we use for population (program) snapshots? \n0: Text (.pop) \n1: Binary (.popb; see scripts/popsnapshot.py) \n2: Both"),
+  VALUE(SNAPSHOT_REUSE_PHENOTYPES, bool, true, "Should snapshots reuse phenotypes from the most recent evaluation of an organism (in place of its first snapshot trial) when available?"),
+  VALUE(CHECKPOINT_INTERVAL, size_t, 0, "How often should we checkpoint the world (so a killed run can be resumed)? (0 = never)"),
+  VALUE(RESUME, bool, false, "Should we resume from the last checkpoint (if there is one)?"),
+  VALUE(PHASE_TIMING, bool, false, "Should we record wall-clock time spent in each phase (evaluation, selection, update) of every update? (phase_timing.csv; checkpointing not included)"),
 )
 
 #endif
\ No newline at end of file
@@ -1,7 +1,8 @@
 #ifndef __MAP_ELITES_GP_H__
 #define __MAP_ELITES_GP_H__
 
-#include <set>
+#include <algorithm>
+#include <unordered_map>
 #include <sys/stat.h>
 
 #include "Evolve/World.h"
@@ -15,6 +16,11 @@
 #include "MapElitesGP_Config.h"
 #include "TaskSet.h"
 #include "TestcaseSet.h"
+#include "PopSnapshot.h"
+#include "Checkpoint.h"
+#include "RandomStreams.h"
+#include "WorkerPool.h"
+#include "PhaseTiming.h"
 
 class MapElitesScopeGPWorld : public emp::World<emp::AvidaGP> {
 
@@ -48,47 +54,123 @@ public:
     size_t SELECTION;
     size_t PROBLEM_TYPE;
     std::string TESTCASES_FPATH;
+    bool TESTCASES_CACHE;
     size_t SNAPSHOT_INTERVAL;
     size_t STATISTICS_INTERVAL;
+    size_t POP_SNAPSHOT_FORMAT;
+    size_t CHECKPOINT_INTERVAL;
+    bool RESUME;
+    bool EVAL_EARLY_EXIT;
+    bool FIRST_SUBMIT_WINS;
+    size_t LOGIC_INPUT_POOL_SIZE;
+    size_t EVAL_THREADS;
+    bool PHASE_TIMING;
+
+    PhaseTimer phase_timer;               ///< Wall-clock time spent in each phase of the current update.
+    std::ofstream phase_timing_ofstream;  ///< Phase timing, one row per update (if PHASE_TIMING).
+
+    std::string checkpoint_fpath = "checkpoint.ckpt";
+    CheckpointFiles ckpt_files;     ///< Output files that pick up where they left off when we resume.
+    CheckpointReader resume_ckpt;   ///< Checkpoint we're resuming from (if resuming).
+    bool resuming = false;          ///< Did this run start from a checkpoint?
+    uint64_t run_seed = 0;          ///< Base seed for the world random number stream (reseeded every update when checkpointing).
+    emp::vector<double> fitness_node_vals; ///< Values collected by the fitness data node at the end of the last update.
 
     emp::DataNode<double, emp::data::Range> evolutionary_distinctiveness;
 
-    taskset_t task_set;
-    std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS> task_inputs;
-    size_t input_load_id;
+    taskset_t task_set;                     ///< Task set prototype (each evaluation context gets its own copy).
+    taskset_t::InputPool logic_input_pool;  ///< Collision-free logic task inputs (if LOGIC_INPUT_POOL_SIZE).
     
     emp::AvidaGP::inst_lib_t inst_set;
 
-    TestcaseSet<int, double> testcases;
+    TestcaseSet<double, double> testcases;
 
     emp::vector<std::function<double(emp::AvidaGP&)> > fit_set;
 
-    std::function<double(emp::AvidaGP&)> goal_function = [this](emp::AvidaGP & org){
+    /// Everything we learn from evaluating an organism, gathered during a single execution (see Evaluate).
+    struct OrgEval {
+        double fitness;
+        uint32_t scopes;                  ///< Bitset of scopes the program was in at any point during evaluation.
+        double inst_entropy;
+        emp::vector<double> case_scores;  ///< Score on each lexicase case (test case, or logic task).
+
+        size_t GetScopeCnt() const {
+            size_t cnt = 0;
+            for (uint32_t bits = scopes; bits; bits &= bits - 1) ++cnt;
+            return cnt;
+        }
+    };
+    /// Evaluations of living organisms (and any offspring waiting to be placed).
+    /// Entries are dropped when an organism dies, and when a new organism is created at a recycled address.
+    std::unordered_map<const emp::AvidaGP *, OrgEval> org_evals;
+
+    /// Keeps track of the lowest output ID a program has written to (the output both problems score) without walking
+    /// the hardware's output map every step: outputs only ever get added while a program runs, so we only need to look
+    /// again when the number of outputs changes. Reset whenever the hardware is.
+    struct LowestOutputTracker {
+        static constexpr int NONE = 100000;  ///< Output IDs at or past this never count as lowest (as always).
+        size_t output_cnt = 0;
+        int id = NONE;
+
+        void Reset() { output_cnt = 0; id = NONE; }
+
+        /// Bring id up to date with org's outputs.
+        void Update(emp::AvidaGP & org) {
+            const std::unordered_map<int, double> & outputs = org.GetOutputs();
+            if (outputs.size() == output_cnt) return;
+            output_cnt = outputs.size();
+            id = NONE;
+            for (const auto & out : outputs) id = std::min(id, out.first);
+        }
+
+        bool HasOutput() const { return output_cnt > 0; }
+        bool HasLowest() const { return id < NONE; }
+    };
+
+    /// Everything an evaluation writes to (one per evaluation worker, so organisms can be evaluated in parallel).
+    struct EvalContext {
+        taskset_t task_set;
+        std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS> task_inputs;
+        emp::Random rnd;                  ///< Reseeded at the start of every evaluation.
+        uint32_t scopes;                  ///< Scopes entered so far during the current evaluation.
+        emp::vector<double> case_scores;  ///< Lexicase case scores so far during the current evaluation.
+        emp::vector<size_t> inst_cnts;    ///< Scratch space for counting instructions (instruction entropy).
+        LowestOutputTracker lowest_output;
+        size_t testcase_steps_run;        ///< Hardware steps executed on testcases this update.
+        size_t testcases_run;             ///< Testcases run this update.
+        size_t evals_run;                 ///< Evaluations run this update.
+
+        EvalContext()
+          : task_set(), task_inputs(), rnd(1), scopes(0), case_scores(), inst_cnts(), lowest_output(),
+            testcase_steps_run(0), testcases_run(0), evals_run(0) { ; }
+    };
+    emp::vector<EvalContext> eval_ctxs;
+    WorkerPool eval_pool;                 ///< Worker threads used to evaluate the population.
+    emp::vector<size_t> eval_queue;       ///< Population positions that need to be evaluated this update.
+    emp::vector<uint32_t> eval_seeds;     ///< Random number seed for each evaluation in eval_queue.
+    emp::vector<OrgEval> eval_results;    ///< Evaluation results for each organism in eval_queue.
+
+    std::function<double(emp::AvidaGP&, EvalContext&)> goal_function = [this](emp::AvidaGP & org, EvalContext & ctx){
         double score = 0;
-        emp::Random rand = GetRandom();
-        // for (int testcase : testcases.GetSubset(N_TEST_CASES, &rand)) {
-        emp_assert(N_TEST_CASES <= testcases.GetTestcases().size(), N_TEST_CASES, testcases.GetTestcases().size());
+        emp_assert(N_TEST_CASES <= testcases.GetSize(), N_TEST_CASES, testcases.GetSize());
         for (size_t testcase = 0; testcase < N_TEST_CASES; ++testcase) {
+            const auto inputs = testcases.GetInput(testcase);
+            const double & answer = testcases.GetOutput(testcase);
             org.ResetHardware();
-            for (size_t i = 0; i < testcases[testcase].first.size(); i++) {
-                org.SetInput((int)i, testcases[testcase].first[i]);
+            ctx.lowest_output.Reset();
+            for (size_t i = 0; i < inputs.size(); i++) {
+                org.SetInput((int)i, inputs[i]);
             }
-            org.Process(EVAL_TIME);
-            double divisor = testcases[testcase].second;
+            ProcessTestcase(org, ctx);
+            double divisor = answer;
             if (divisor == 0) {
                 divisor = 1;
             }
-            const std::unordered_map<int, double> & outputs = org.GetOutputs();
-            int min_output = 100000;
+            ctx.lowest_output.Update(org);
             double result;
-            for (auto out : outputs) {
-                if (out.first < min_output) {
-                    min_output = out.first;
-                }
-            }
 
-            if (outputs.size() != 0) {
-                result = 1 / (std::abs(org.GetOutput(min_output) - testcases[testcase].second)/std::abs(divisor));
+            if (ctx.lowest_output.HasOutput()) {
+                result = 1 / (std::abs(org.GetOutput(ctx.lowest_output.id) - answer)/std::abs(divisor));
             } else {
                 result = 0;
             }
@@ -97,6 +179,7 @@ public:
             if (result > 1000) {
                 result = 1000;
             }
+            ctx.case_scores.push_back(result);
             score += result;
         }
         return score;
@@ -109,28 +192,86 @@ public:
     MapElitesScopeGPWorld() {;}
     MapElitesScopeGPWorld(emp::Random & rnd) : emp::World<emp::AvidaGP>(rnd) {;}
 
-    std::function<int(emp::AvidaGP &)> scope_count_fun = [this](emp::AvidaGP & val){ 
-        std::set<size_t> scopes;
-        val.ResetHardware();
-        val.SetInput(0, 1);
-        scopes.insert(val.CurScope());
+    /// Evaluate org (running goal_function) using ctx, collecting its MAP-Elites traits and lexicase case scores
+    /// from the same execution. Any randomness comes from seed, so results don't depend on which worker runs this.
+    OrgEval Evaluate(emp::AvidaGP & org, EvalContext & ctx, uint32_t seed) {
+        OrgEval eval;
+        ctx.rnd.ResetSeed(DeriveStreamSeed(seed, {}));
+        ctx.scopes = 0;
+        ctx.case_scores.clear();
+        eval.fitness = goal_function(org, ctx);
+        eval.scopes = ctx.scopes;
+        eval.inst_entropy = CalcInstEntropy(org, ctx);
+        eval.case_scores = ctx.case_scores;
+        ++ctx.evals_run;
+        return eval;
+    }
+
+    /// Get org's evaluation, evaluating it (on the main thread) if this is the first time anyone has asked.
+    const OrgEval & GetEval(emp::AvidaGP & org) {
+        auto it = org_evals.find(&org);
+        if (it == org_evals.end()) it = org_evals.emplace(&org, Evaluate(org, eval_ctxs[0], random_ptr->GetUInt())).first;
+        return it->second;
+    }
+
+    /// Evaluate every organism in the population that hasn't been evaluated yet (in parallel if we have multiple
+    /// evaluation workers), so fitness and lexicase lookups during selection never need to run anything.
+    void EvaluatePopulation() {
+        // 1) Serially, figure out who needs evaluating, and hand out random number seeds (in order).
+        eval_queue.clear();
+        eval_seeds.clear();
+        for (size_t id = 0; id < GetSize(); ++id) {
+            if (!pop[id] || org_evals.count(pop[id].Raw())) continue;
+            eval_queue.emplace_back(id);
+            eval_seeds.emplace_back(random_ptr->GetUInt());
+        }
+        // 2) Evaluate (in parallel if we have multiple evaluation workers).
+        eval_results.resize(eval_queue.size());
+        eval_pool.Run(eval_queue.size(), [this](size_t worker_id, size_t job_id) {
+            eval_results[job_id] = Evaluate(*pop[eval_queue[job_id]], eval_ctxs[worker_id], eval_seeds[job_id]);
+        });
+        // 3) Serially, remember results.
+        for (size_t i = 0; i < eval_queue.size(); ++i) {
+            org_evals.emplace(pop[eval_queue[i]].Raw(), std::move(eval_results[i]));
+        }
+    }
 
-        for (int i = 0; i < EVAL_TIME; i++) {
-            val.SingleProcess();
-            scopes.insert(val.CurScope());
+    /// Shannon entropy of the instructions in org's genome.
+    double CalcInstEntropy(emp::AvidaGP & org, EvalContext & ctx) {
+        const auto & sequence = org.GetGenome().sequence;
+        emp::vector<size_t> & inst_cnts = ctx.inst_cnts;
+        inst_cnts.assign(inst_set.GetSize(), 0);
+        for (const auto & inst : sequence) ++inst_cnts[inst.id];
+        double entropy = 0;
+        for (size_t cnt : inst_cnts) {
+            if (!cnt) continue;
+            const double p = cnt / (double)sequence.size();
+            entropy -= p * emp::Log2(p);
         }
-        return scopes.size(); 
+        return entropy;
+    }
+
+    /// Note which scope org is currently in (for the current evaluation).
+    void NoteScope(emp::AvidaGP & org, EvalContext & ctx) {
+        ctx.scopes |= (uint32_t)1 << std::min<size_t>(org.CurScope(), 31);
+    }
+
+    /// Advance org a single step (noting which scope it ends up in).
+    void StepOrg(emp::AvidaGP & org, EvalContext & ctx) {
+        org.SingleProcess();
+        NoteScope(org, ctx);
+    }
+
+    std::function<int(emp::AvidaGP &)> scope_count_fun = [this](emp::AvidaGP & org){ 
+        return (int)GetEval(org).GetScopeCnt();
     };
 
    std::function<int(size_t id)> scope_count_fun_ptr = [this](size_t id){ 
         return scope_count_fun(*pop[id]);
     };
 
-    std::function<size_t(emp::AvidaGP::Instruction&)> GetInstID = [](emp::AvidaGP::Instruction & inst){return inst.id;};
-
-    std::function<double(emp::AvidaGP &)> inst_ent_fun = [this](emp::AvidaGP & val){ 
-        emp::vector<size_t> inst_list = emp::ApplyFunction(GetInstID, val.GetGenome().sequence);
-        return emp::ShannonEntropy(inst_list); 
+    std::function<double(emp::AvidaGP &)> inst_ent_fun = [this](emp::AvidaGP & org){ 
+        return GetEval(org).inst_entropy;
     };
 
     std::function<double(size_t id)> inst_ent_fun_ptr = [this](size_t id){ 
@@ -154,6 +295,7 @@ public:
         inst_set = emp::AvidaGP::inst_lib_t::DefaultInstLib();
         SetCache();
         InitConfigs(config);
+        InitCheckpointing();
         SetMutFun([this](emp::AvidaGP & org, emp::Random & r){
             int count = 0;
             for (size_t i = 0; i < org.GetSize(); ++i) {
@@ -186,14 +328,47 @@ public:
         });
         SetPopStruct_Mixed();
         SetAutoMutate();
+        // Keep org_evals in step with who's alive.
+        OnOffspringReady([this](emp::AvidaGP & org) { org_evals.erase(&org); });
+        OnInjectReady([this](emp::AvidaGP & org) { org_evals.erase(&org); });
+        OnOrgDeath([this](size_t pos) { org_evals.erase(pop[pos].Raw()); });
         
         #ifndef EMSCRIPTEN
-        SetupFitnessFile().SetTimingRepeat(STATISTICS_INTERVAL);
+        // Fitness and population files (same columns as World::SetupFitnessFile/SetupPopulationFile, but resumable).
+        emp::DataFile & fit_file = AddDataFile(ckpt_files.OpenDataFile("fitness.csv"));
+        auto & fit_node = GetFitnessDataNode();
+        fit_file.AddVar(update, "update", "Update");
+        fit_file.AddMean(fit_node, "mean_fitness", "Average organism fitness in current population.");
+        fit_file.AddMin(fit_node, "min_fitness", "Minimum organism fitness in current population.");
+        fit_file.AddMax(fit_node, "max_fitness", "Maximum organism fitness in current population.");
+        fit_file.AddInferiority(fit_node, "inferiority", "Average fitness / maximum fitness in current population.");
+        if (PROBLEM_TYPE == (size_t)PROBLEM_TYPE::TESTCASES) {
+            fit_file.AddFun(std::function<double()>([this]() { 
+                size_t steps = 0, cases = 0;
+                for (const EvalContext & ctx : eval_ctxs) { steps += ctx.testcase_steps_run; cases += ctx.testcases_run; }
+                return (cases) ? steps / (double)cases : 0.0; 
+            }), "testcase_steps_per_case", "Average hardware steps executed per testcase this update.");
+            OnUpdate([this](size_t) { for (EvalContext & ctx : eval_ctxs) { ctx.testcase_steps_run = 0; ctx.testcases_run = 0; } });
+        }
+        if (!ckpt_files.IsResuming("fitness.csv")) fit_file.PrintHeaderKeys();
+        fit_file.SetTimingRepeat(STATISTICS_INTERVAL);
+        if (CHECKPOINT_INTERVAL) {
+            // Remember what goes into the fitness node at the end of every update, so we can refill it on resume.
+            OnUpdate([this](size_t) {
+                fitness_node_vals.clear();
+                for (size_t id = 0; id < GetSize(); ++id) {
+                    if (IsOccupied(id)) fitness_node_vals.emplace_back(GetCache(id));
+                }
+            });
+        }
         // SetupSystematicsFile().SetTimingRepeat(10);
-        SetupPopulationFile().SetTimingRepeat(STATISTICS_INTERVAL);
+        emp::DataFile & pop_file = AddDataFile(ckpt_files.OpenDataFile("population.csv"));
+        pop_file.AddVar(update, "update", "Update");
+        pop_file.AddVar(num_orgs, "num_orgs", "Number of organisms currently living in the population.");
+        if (!ckpt_files.IsResuming("population.csv")) pop_file.PrintHeaderKeys();
+        pop_file.SetTimingRepeat(STATISTICS_INTERVAL);
 
-        emp::Ptr<emp::ContainerDataFile<emp::vector<size_t> > > tfile;
-        tfile.New("traits.dat");
+        auto tfile = ckpt_files.OpenDataFile<emp::ContainerDataFile<emp::vector<size_t> > >("traits.dat");
 
         auto & trait_file = static_cast<emp::ContainerDataFile<emp::vector<size_t> >& >(AddDataFile(tfile));
         trait_file.SetUpdateContainerFun(get_pop);
@@ -205,7 +380,12 @@ public:
 	    trait_file.AddContainerFun(inst_ent_bin, "inst_ent_bin", "Bin that instruction entropy falls into");
         trait_file.AddVar(update, "update", "Update");
         trait_file.SetTimingRepeat(STATISTICS_INTERVAL);
-        trait_file.PrintHeaderKeys();
+        if (!ckpt_files.IsResuming("traits.dat")) trait_file.PrintHeaderKeys();
+
+        if (PHASE_TIMING) {
+            ckpt_files.Open(phase_timing_ofstream, "phase_timing.csv");
+            if (!ckpt_files.IsResuming("phase_timing.csv")) phase_timer.PrintHeader(phase_timing_ofstream);
+        }
 
         OnUpdate([this](size_t ud){if (ud % SNAPSHOT_INTERVAL == 0){SnapshotSingleFile(ud);}});
         #endif
@@ -213,7 +393,7 @@ public:
         if (PROBLEM_TYPE == (size_t)PROBLEM_TYPE::LOGIC) {
             SetupProblem_Logic();
         } else if (PROBLEM_TYPE == (size_t)PROBLEM_TYPE::TESTCASES) {
-            testcases.LoadTestcases(TESTCASES_FPATH);
+            testcases.LoadTestcases(TESTCASES_FPATH, true, TESTCASES_CACHE);
 
             inst_set.AddInst("Dereference", [](emp::AvidaGP::hardware_t & hw, const emp::AvidaGP::inst_t & inst) {
                if (hw.regs[inst.args[0]] >= 0 && hw.regs[inst.args[0]] < hw.regs.size()) {
@@ -223,52 +403,26 @@ public:
 
             if (SELECTION == (size_t)SELECTION_METHOD::LEXICASE) {
 
+                // Test case results are recorded by goal_function (see Evaluate).
                 for (size_t testcase = 0; testcase < N_TEST_CASES; ++testcase) {
                     fit_set.push_back([testcase, this](emp::AvidaGP & org) {
-                        org.ResetHardware();
-                        for (size_t i = 0; i < testcases[testcase].first.size(); i++) {
-                            org.SetInput((int)i, testcases[testcase].first[i]);
-                        }
-                        org.Process(EVAL_TIME);
-                        double divisor = testcases[testcase].second;
-                        if (divisor == 0) {
-                            divisor = 1;
-                        }
-                        const std::unordered_map<int, double> & outputs = org.GetOutputs();
-                        int min_output = 100000;
-                        double result;
-                        for (auto out : outputs) {
-                            if (out.first < min_output) {
-                                min_output = out.first;
-                            }
-                        }
-
-                        if (outputs.size() != 0) {
-                            result = 1 / (std::abs(org.GetOutput(min_output) - testcases[testcase].second)/std::abs(divisor));
-                        } else {
-                            result = 0;
-                        }
-
-                        // emp_assert(std::abs(result) != INFINITY);
-                        if (result > 1000) {
-                            result = 1000;
-                        }
-                        return result;
+                        return GetEval(org).case_scores[testcase];
                     });
-
                 }
             }
 
         }
 
-        SetFitFun(goal_function);
+        InitEvalContexts();
+        SetFitFun([this](emp::AvidaGP & org) { return GetEval(org).fitness; });
         AddPhenotype("Num Scopes", scope_count_fun, 1, 17);
         AddPhenotype("Entropy", inst_ent_fun, 0, -1*emp::Log2(1.0/inst_set.GetSize())+1);
         if (WORLD_STRUCTURE == (size_t)STRUCTURE::MAPE) {
             emp::SetMapElites(*this, {SCOPE_RES, ENTROPY_RES});
         }
 
-        InitPop();
+        if (resuming) RestoreCheckpoint();
+        else InitPop();
     }
 
     void SnapshotSingleFile(size_t update) {
@@ -276,17 +430,38 @@ public:
         #ifndef EMSCRIPTEN
         mkdir(snapshot_dir.c_str(), ACCESSPERMS);
         #endif        
-        // For each program in the population, dump the full program description in a single file.
-        std::ofstream prog_ofstream(snapshot_dir + "/pop_" + emp::to_string((int)update) + ".pop");
-        for (size_t i : GetValidOrgIDs())
-        {
-            if (pop[i]) {
-                prog_ofstream << "===\n";
-                prog_ofstream << "id: " << i << ", scope_bin: " << scope_count_bin(i) << ", inst_ent_bin: " << inst_ent_bin(i) << ", fitness: " << goal_function(*pop[i]) << std::endl;
-                pop[i]->PrintGenome(prog_ofstream);
+        const std::string fpath = snapshot_dir + "/pop_" + emp::to_string((int)update);
+        if (POP_SNAPSHOT_FORMAT == (size_t)POP_SNAPSHOT_FORMAT::TEXT || POP_SNAPSHOT_FORMAT == (size_t)POP_SNAPSHOT_FORMAT::BOTH) {
+            // For each program in the population, dump the full program description in a single file.
+            std::ofstream prog_ofstream(fpath + ".pop");
+            for (size_t i : GetValidOrgIDs())
+            {
+                if (pop[i]) {
+                    prog_ofstream << "===\n";
+                    prog_ofstream << "id: " << i << ", scope_bin: " << scope_count_bin(i) << ", inst_ent_bin: " << inst_ent_bin(i) << ", fitness: " << GetEval(*pop[i]).fitness << std::endl;
+                    pop[i]->PrintGenome(prog_ofstream);
+                }
             }
+            prog_ofstream.close();
+        }
+        if (POP_SNAPSHOT_FORMAT == (size_t)POP_SNAPSHOT_FORMAT::BINARY || POP_SNAPSHOT_FORMAT == (size_t)POP_SNAPSHOT_FORMAT::BOTH) {
+            SnapshotBinary(update, fpath + ".popb");
+        }
+    }
+
+    /// Write population snapshot in binary format (see PopSnapshot.h); each genome is stored as a single untagged function.
+    void SnapshotBinary(size_t update, const std::string & fpath) {
+        PopSnapshotWriter writer(POP_SNAPSHOT_KIND::AVIDAGP, GetSize(), 0, emp::AvidaGP::base_t::INST_ARGS, update);
+        writer.AddAxis("scope_bin", SCOPE_RES);
+        writer.AddAxis("inst_ent_bin", ENTROPY_RES);
+        for (size_t i = 0; i < inst_set.GetSize(); ++i) writer.AddInstDef(inst_set.GetName(i), inst_set.GetNumArgs(i));
+        for (size_t i : GetValidOrgIDs()) {
+            if (!pop[i]) continue;
+            writer.BeginOrg(i, GetEval(*pop[i]).fitness, 0.0, {scope_count_bin(i), inst_ent_bin(i)});
+            writer.BeginFunction();
+            for (const auto & inst : pop[i]->GetGenome().sequence) writer.AddInst(inst.id, inst.args);
         }
-        prog_ofstream.close();
+        if (!writer.Save(fpath)) std::cout << "Failed to write population snapshot (" << fpath << ")." << std::endl;
     }
 
     void InitConfigs(MapElitesGPConfig & config) {
@@ -305,9 +480,139 @@ public:
         SELECTION = config.SELECTION_METHOD();
         PROBLEM_TYPE = config.PROBLEM_TYPE();        
         TESTCASES_FPATH = config.TESTCASES_FPATH();
+        TESTCASES_CACHE = config.TESTCASES_CACHE();
         WORLD_STRUCTURE = config.WORLD_STRUCTURE();
         SNAPSHOT_INTERVAL = config.SNAPSHOT_INTERVAL();        
         STATISTICS_INTERVAL = config.STATISTICS_INTERVAL();        
+        POP_SNAPSHOT_FORMAT = config.POP_SNAPSHOT_FORMAT();
+        CHECKPOINT_INTERVAL = config.CHECKPOINT_INTERVAL();
+        RESUME = config.RESUME();
+        EVAL_EARLY_EXIT = config.EVAL_EARLY_EXIT();
+        FIRST_SUBMIT_WINS = config.FIRST_SUBMIT_WINS();
+        LOGIC_INPUT_POOL_SIZE = config.LOGIC_INPUT_POOL_SIZE();
+        EVAL_THREADS = config.EVAL_THREADS();
+        PHASE_TIMING = config.PHASE_TIMING();
+    }
+
+    /// Set up evaluation workers, each with its own evaluation context (must happen after problem setup).
+    void InitEvalContexts() {
+        std::cout << "Configuring evaluation workers (" << EVAL_THREADS << ")" << std::endl;
+        eval_pool.Resize(EVAL_THREADS);
+        EVAL_THREADS = eval_pool.GetSize();
+        eval_ctxs.resize(EVAL_THREADS);
+        for (EvalContext & ctx : eval_ctxs) ctx.task_set = task_set;
+    }
+
+    /// Run org on a testcase (inputs must already be set), returning how many steps it actually ran for.
+    /// AvidaGP programs never halt, so the only way a testcase settles early is output being final under FIRST_SUBMIT_WINS.
+    /// (AvidaGP outputs can't be frozen, so FIRST_SUBMIT_WINS always stops at the first output, with or without EVAL_EARLY_EXIT.)
+    size_t ProcessTestcase(emp::AvidaGP & org, EvalContext & ctx) {
+        size_t steps = EVAL_TIME;
+        NoteScope(org, ctx);
+        if (FIRST_SUBMIT_WINS) {
+            for (steps = 0; steps < EVAL_TIME && org.GetOutputs().size() == 0; ++steps) StepOrg(org, ctx);
+        } else {
+            for (size_t t = 0; t < EVAL_TIME; ++t) StepOrg(org, ctx);
+        }
+        ctx.testcase_steps_run += steps;
+        ++ctx.testcases_run;
+        return steps;
+    }
+
+    /// If we're resuming, load the checkpoint and pick up its random number seed/update.
+    /// (The population gets restored at the end of Setup; see RestoreCheckpoint.)
+    void InitCheckpointing() {
+        run_seed = (uint64_t)random_ptr->GetSeed();
+        resuming = false;
+        if (!RESUME) return;
+        if (!resume_ckpt.Load(checkpoint_fpath, CHECKPOINT_KIND::SCOPEGP)) {
+            if (std::ifstream(checkpoint_fpath).good()) {
+                std::cout << "Failed to load checkpoint (" << checkpoint_fpath << "). Exiting..." << std::endl;
+                exit(-1);
+            }
+            std::cout << "No checkpoint to resume from (" << checkpoint_fpath << "); starting from scratch." << std::endl;
+            return;
+        }
+        run_seed = resume_ckpt.Get<uint64_t>();
+        update = (size_t)resume_ckpt.Get<uint64_t>();
+        ckpt_files.Load(resume_ckpt);
+        if (!resume_ckpt.IsOK()) {
+            std::cout << "Failed to load checkpoint (" << checkpoint_fpath << "). Exiting..." << std::endl;
+            exit(-1);
+        }
+        random_ptr->ResetSeed((int)run_seed);
+        resuming = true;
+        std::cout << "Resuming from checkpoint (" << checkpoint_fpath << ") at update " << update << "." << std::endl;
+    }
+
+    /// Checkpoints are taken at the end of an update; they hold the population (or MAP), each organism's evaluation
+    /// (if it has one yet), cached fitnesses, and data file lengths. Evaluations have to be saved: re-evaluating
+    /// survivors after a resume would draw different evaluation seeds than the original run did.
+    void SaveCheckpoint() {
+        CheckpointWriter ckpt(CHECKPOINT_KIND::SCOPEGP);
+        ckpt.Put(run_seed);
+        ckpt.Put((uint64_t)update);
+        ckpt_files.Save(ckpt);
+        ckpt.Put((uint64_t)GetSize());
+        for (size_t id = 0; id < GetSize(); ++id) {
+            ckpt.Put((uint8_t)IsOccupied(id));
+            if (!IsOccupied(id)) continue;
+            const auto & sequence = pop[id]->GetGenome().sequence;
+            ckpt.Put((uint64_t)sequence.size());
+            for (const auto & inst : sequence) {
+                ckpt.Put((uint32_t)inst.id);
+                for (size_t a = 0; a < emp::AvidaGP::base_t::INST_ARGS; ++a) ckpt.Put((uint32_t)inst.args[a]);
+            }
+            auto eval_it = org_evals.find(pop[id].Raw());
+            ckpt.Put((uint8_t)(eval_it != org_evals.end()));
+            if (eval_it == org_evals.end()) continue;
+            const OrgEval & eval = eval_it->second;
+            ckpt.Put(eval.fitness);
+            ckpt.Put(eval.scopes);
+            ckpt.Put(eval.inst_entropy);
+            ckpt.PutVector(eval.case_scores);
+        }
+        ckpt.PutVector(fit_cache);
+        ckpt.PutVector(fitness_node_vals);
+        if (!ckpt.Save(checkpoint_fpath)) std::cout << "Failed to write checkpoint (" << checkpoint_fpath << ")." << std::endl;
+    }
+
+    void RestoreCheckpoint() {
+        CheckpointReader & ckpt = resume_ckpt;
+        const uint64_t pop_size = ckpt.Get<uint64_t>();
+        bool valid = true;
+        for (size_t id = 0; id < pop_size && ckpt.IsOK() && valid; ++id) {
+            if (!ckpt.Get<uint8_t>()) continue;
+            emp::AvidaGP cpu(&inst_set);
+            const uint64_t len = ckpt.Get<uint64_t>();
+            for (size_t i = 0; i < len && ckpt.IsOK(); ++i) {
+                const size_t inst_id = ckpt.Get<uint32_t>();
+                size_t args[emp::AvidaGP::base_t::INST_ARGS];
+                for (size_t a = 0; a < emp::AvidaGP::base_t::INST_ARGS; ++a) args[a] = ckpt.Get<uint32_t>();
+                if (inst_id >= inst_set.GetSize()) { valid = false; break; }
+                cpu.PushInst(inst_id, args[0], args[1], args[2]);
+            }
+            if (!valid || !ckpt.IsOK()) break;
+            InjectAt(cpu.GetGenome(), emp::WorldPosition(id));
+            if (!ckpt.Get<uint8_t>()) continue;
+            OrgEval eval;
+            eval.fitness = ckpt.Get<double>();
+            eval.scopes = ckpt.Get<uint32_t>();
+            eval.inst_entropy = ckpt.Get<double>();
+            ckpt.GetVector(eval.case_scores);
+            org_evals[pop[id].Raw()] = std::move(eval);
+        }
+        ckpt.GetVector(fit_cache);
+        ckpt.GetVector(fitness_node_vals);
+        #ifndef EMSCRIPTEN
+        auto & fit_node = GetFitnessDataNode();
+        fit_node.Reset();
+        for (double val : fitness_node_vals) fit_node.Add(val);
+        #endif
+        if (!ckpt.IsOK() || !valid || GetSize() != pop_size) {
+            std::cout << "Failed to restore world from checkpoint (" << checkpoint_fpath << "). Exiting..." << std::endl;
+            exit(-1);
+        }
     }
 
     void InitPop() {
@@ -323,8 +628,15 @@ public:
     }
 
     void RunStep() {
+        // When checkpointing, every update draws from its own world random number stream (so we can restart mid-run).
+        if (CHECKPOINT_INTERVAL || resuming) random_ptr->ResetSeed(DeriveStreamSeed(run_seed, {(uint64_t)update}));
         evolutionary_distinctiveness.Reset();
         std::cout << update << std::endl;
+        const size_t cur_update = update;
+        for (EvalContext & ctx : eval_ctxs) ctx.evals_run = 0;
+        phase_timer.Start();
+        EvaluatePopulation();
+        phase_timer.Mark(UPDATE_PHASE::EVALUATION);
         if (WORLD_STRUCTURE == (size_t)STRUCTURE::MAPE) {
             if (num_orgs < .5*GetSize()) {
                 emp::RandomSelectSparse(*this, POP_SIZE);
@@ -340,25 +652,40 @@ public:
         } else {
             emp_assert(false && "INVALID SELECTION SCEHME", SELECTION);
         }
+        phase_timer.Mark(UPDATE_PHASE::SELECTION);
 
         Update();
+        phase_timer.Mark(UPDATE_PHASE::UPDATE);
+        if (PHASE_TIMING) {
+            size_t evals = 0;
+            for (const EvalContext & ctx : eval_ctxs) evals += ctx.evals_run;
+            phase_timer.PrintRow(phase_timing_ofstream, cur_update, evals);
+        }
+        if (CHECKPOINT_INTERVAL && update % CHECKPOINT_INTERVAL == 0) SaveCheckpoint();
     }
 
     void Run() {
-        for (size_t u = 0; u <= GENERATIONS; u++) {
+        for (size_t u = update; u <= GENERATIONS; u++) {
             RunStep();
         }  
     }
 
-    void ResetTasks() {
-        input_load_id = 0;
-        task_inputs[0] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-        task_inputs[1] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-        task_set.SetInputs(task_inputs);
-        while (task_set.IsCollision()) {
-        task_inputs[0] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-        task_inputs[1] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-        task_set.SetInputs(task_inputs);
+    /// Reset logic tasks (in given evaluation context), guaranteeing no solution collisions among the tasks.
+    /// Inputs (or pooled input IDs) are drawn from the context's random number generator, not the world's.
+    void ResetTasks(EvalContext & ctx) {
+        if (logic_input_pool.GetSize()) {
+            const size_t id = ctx.rnd.GetUInt(logic_input_pool.GetSize());
+            ctx.task_inputs = logic_input_pool.GetInputs(id);
+            ctx.task_set.SetPooledInputs(logic_input_pool, id);
+            return;
+        }
+        ctx.task_inputs[0] = ctx.rnd.GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+        ctx.task_inputs[1] = ctx.rnd.GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+        ctx.task_set.SetInputs(ctx.task_inputs);
+        while (ctx.task_set.IsCollision()) {
+            ctx.task_inputs[0] = ctx.rnd.GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+            ctx.task_inputs[1] = ctx.rnd.GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+            ctx.task_set.SetInputs(ctx.task_inputs);
         }
     }
 
@@ -366,10 +693,6 @@ public:
     void SetupProblem_Logic() {
 
         // Configure the tasks. 
-        // Zero out task inputs.
-        for (size_t i = 0; i < MAX_LOGIC_TASK_NUM_INPUTS; ++i) task_inputs[i] = 0;
-        input_load_id = 0;
-
         // Add tasks to set.
         // NAND
         task_set.AddTask("NAND", [](taskset_t::Task & task, const std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS> & inputs) {
@@ -426,39 +749,49 @@ public:
             task.solutions.emplace_back(b);
         }, "ECHO task");
 
+        // Generate collision-free inputs up front (if we're sampling from a pool). 
+        if (LOGIC_INPUT_POOL_SIZE) {
+            task_set.FillInputPool(logic_input_pool, LOGIC_INPUT_POOL_SIZE, [this]() {
+                std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS> inputs;
+                inputs[0] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+                inputs[1] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+                return inputs;
+            });
+        }
+
         inst_set.AddInst("Nand", [](emp::AvidaGP::hardware_t & hw, const emp::AvidaGP::inst_t & inst) {
             hw.regs[inst.args[2]] = ~((int)hw.regs[inst.args[0]]&(int)hw.regs[inst.args[1]]);
         } , 3, "WM[ARG3]=~(WM[ARG1]&WM[ARG2])");
 
         // // setup score
-        goal_function = [this](org_t & org) {
+        goal_function = [this](org_t & org, EvalContext & ctx) {
             // Num unique tasks completed + (TOTAL TIME - COMPLETED TIME)
-            ResetTasks();
+            ResetTasks(ctx);
             org.ResetHardware();
+            ctx.lowest_output.Reset();
 
             for (size_t i = 0; i < MAX_LOGIC_TASK_NUM_INPUTS; i++) {
-                org.SetInput((int)i, task_inputs[i]);
+                org.SetInput((int)i, ctx.task_inputs[i]);
             }
+            NoteScope(org, ctx);
             for (size_t t = 0; t < EVAL_TIME; ++t) {
-                org.SingleProcess();
+                StepOrg(org, ctx);
 
-                int min_output = 100000;
-                for (auto out : org.GetOutputs()) {
-                    if (out.first < min_output) {
-                        min_output = out.first;
-                    }
-                }
-
-                if (min_output < 100000) {
-                    task_set.Submit((uint32_t)org.GetOutput(min_output), t);
-                    if (task_set.AllTasksCompleted()) {
+                ctx.lowest_output.Update(org);
+                if (ctx.lowest_output.HasLowest()) {
+                    ctx.task_set.Submit((uint32_t)org.GetOutput(ctx.lowest_output.id), t);
+                    if (ctx.task_set.AllTasksCompleted()) {
                         break;
                     }
                 }
             }
 
-            double score = task_set.GetUniqueTasksCompleted();
-            if (task_set.GetAllTasksCompletedTime() > 0) score += (EVAL_TIME - task_set.GetAllTasksCompletedTime());
+            // Lexicase cases: was each task completed during this trial?
+            for (size_t task_num = 0; task_num < ctx.task_set.GetSize(); ++task_num) {
+                ctx.case_scores.push_back((double)(ctx.task_set.GetTask(task_num).GetCompletionCnt() > 0));
+            }
+            double score = ctx.task_set.GetUniqueTasksCompleted();
+            if (ctx.task_set.GetAllTasksCompletedTime() > 0) score += (EVAL_TIME - ctx.task_set.GetAllTasksCompletedTime());
             return score;
         };
 
@@ -466,35 +799,10 @@ public:
         if (SELECTION == (size_t)SELECTION_METHOD::LEXICASE) {
             for (size_t task_num = 0; task_num < task_set.GetSize(); ++task_num) {
                 fit_set.push_back([this, task_num](org_t & org) {
-
-                    ResetTasks();
-                    org.ResetHardware();
-
-                    for (size_t i = 0; i < MAX_LOGIC_TASK_NUM_INPUTS; i++) {
-                        org.SetInput((int)i, task_inputs[i]);
-                    }
-                    for (size_t t = 0; t < EVAL_TIME; ++t) {
-                        org.SingleProcess();
-
-                        int min_output = 100000;
-                        for (auto out : org.GetOutputs()) {
-                            if (out.first < min_output) {
-                                min_output = out.first;
-                            }
-                        }
-
-                        if (min_output < 100000) {
-                            task_set.Submit((uint32_t)org.GetOutput(min_output), t);
-                            if (task_set.GetTask(task_num).GetCompletionCnt() > 0) {
-                                break;
-                            }
-                        }
-                    }
-
-                    return (int) (task_set.GetTask(task_num).GetCompletionCnt() > 0);
+                    return GetEval(org).case_scores[task_num];
                 });
             }
-            fit_set.push_back(goal_function);
+            fit_set.push_back([this](org_t & org) { return GetEval(org).fitness; });
        }
 
     }
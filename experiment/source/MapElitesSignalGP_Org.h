@@ -2,9 +2,12 @@
 #define MAPE_SIGNALGP_ORG_H
 
 #include <algorithm>
+#include <functional>
 
 #include "hardware/EventDrivenGP.h"
 
+#include "InstHistogram.h"
+
 class MapElitesSignalGPOrg {
 public:
   struct Genome;
@@ -22,7 +25,8 @@ public:
   /// Hardware trait indexes.                               
   ///   - ORG_STATE - Used to track organism state for changing environment problem.
   ///   - PROBLEM_OUTPUT - used to track organism's output to a problem.                              ///
-  enum HW_TRAIT_ID { ORG_ID=0, PROBLEM_OUTPUT=1, ORG_STATE=2, OUTPUT_SET=3 }; 
+  ///   - WORKER_ID - Used to find the evaluation context (worker) running this hardware.
+  enum HW_TRAIT_ID { ORG_ID=0, PROBLEM_OUTPUT=1, ORG_STATE=2, OUTPUT_SET=3, WORKER_ID=4 }; 
 
   /// Struct to keep track of the genome, which includes everything that we directly mutate/evolve.
   struct Genome {
@@ -33,6 +37,26 @@ public:
     Genome(Genome && in) : program(in.program), tag_sim_thresh(in.tag_sim_thresh) { ; }
     Genome(const Genome & in) : program(in.program), tag_sim_thresh(in.tag_sim_thresh) { ; }
 
+    /// Fast (non-cryptographic) hash of everything in the genome. 
+    size_t Hash() const {
+      size_t h = std::hash<double>()(tag_sim_thresh);
+      auto combine = [&h](size_t v) { h ^= v + (size_t)0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+      auto combine_tag = [&combine](const typename hardware_t::affinity_t & tag) {
+        for (size_t i = 0; i < (TAG_WIDTH + 31) / 32; ++i) combine(tag.GetUInt(i));
+      };
+      for (size_t fID = 0; fID < program.GetSize(); ++fID) {
+        combine_tag(program[fID].affinity);
+        combine(program[fID].GetSize());
+        for (size_t i = 0; i < program[fID].GetSize(); ++i) {
+          const inst_t & inst = program[fID][i];
+          combine(inst.id);
+          for (size_t k = 0; k < inst.args.size(); ++k) combine((size_t)inst.args[k]);
+          combine_tag(inst.affinity);
+        }
+      }
+      return h;
+    }
+
     bool operator==(const Genome & in) const { return program == in.program && tag_sim_thresh == in.tag_sim_thresh; }
     bool operator!=(const Genome & in) const { return !(*this == in); }
     bool operator<(const Genome & other) const {
@@ -50,15 +74,15 @@ protected:
   
   /// Information about organism genome
   /// (e.g. program stats, stuff that doesn't change in context of environment)
+  /// Offspring inherit it from their parent, and mutations keep the instruction histogram up to date (see 
+  /// ProgramMutator), so it only needs to be calculated from scratch for organisms without a (calculated) parent.
   struct GenomeInfo {
-    bool calculated; ///< Have we already calculated this information for this organism? 
+    bool calculated;          ///< Is inst_hist up to date with the program? 
+    bool entropy_calculated;  ///< Is inst_entropy up to date with inst_hist? 
     double inst_entropy;
-    double inst_cnt; 
-
-    GenomeInfo() : calculated(false), inst_entropy(0), inst_cnt(0) { ; }
-    GenomeInfo(GenomeInfo && in) : calculated(in.calculated), inst_entropy(in.inst_entropy), inst_cnt(in.inst_cnt) { ; }
-    GenomeInfo(const GenomeInfo & in) : calculated(in.calculated), inst_entropy(in.inst_entropy), inst_cnt(in.inst_cnt) { ; }
+    InstHistogram inst_hist;  ///< Number of times each instruction (by id) appears in program.
 
+    GenomeInfo() : calculated(false), entropy_calculated(false), inst_entropy(0), inst_hist() { ; }
   } genome_info;
 
 public:
@@ -83,35 +107,57 @@ public:
 
   /// Reset genome information (i.e., flag that it is no longer accurate). 
   void ResetGenomeInfo() { genome_info.calculated = false; }
+
+  /// Flag that the program changed, but the instruction histogram was kept up to date. 
+  void ResetInstEntropy() { genome_info.entropy_calculated = false; }
+
+  /// Has genome information been calculated (and not reset since)?
+  bool HasGenomeInfo() const { return genome_info.calculated; }
+
+  /// Instruction histogram for mutators to keep up to date (nullptr if genome information isn't calculated).
+  InstHistogram * GetInstHistogram() { return (genome_info.calculated) ? &genome_info.inst_hist : nullptr; }
+
+  /// Start out with parent's genome information (if it has any); our genome must be a copy of parent's. 
+  void InheritGenomeInfo(const MapElitesSignalGPOrg & parent) {
+    emp_assert(genome == parent.genome);
+    if (parent.genome_info.calculated) genome_info = parent.genome_info;
+    else genome_info.calculated = false;
+  }
   
-  /// Calculate genome information, filling out genome_info member variable. 
+  /// Calculate genome information from scratch, filling out genome_info member variable. 
+  /// The histogram is sized for the instruction set, so (after the first call) this does not allocate. 
   void CalcGenomeInfo() {
-    // - inst entropy
-    emp::vector<inst_t> inst_seq;
     program_t & prog = GetProgram();
-    for (size_t fID = 0; fID < prog.GetSize(); ++fID) {
-      for (size_t i = 0; i < prog[fID].GetSize(); ++i) {
-        inst_seq.emplace_back(prog[fID][i].id);
-      }
-    }
-    genome_info.inst_entropy = std::max(emp::ShannonEntropy(inst_seq), 0.0);
-    
-    // - inst count (genome length)
-    genome_info.inst_cnt = inst_seq.size();
-    
+    InstHistogram & hist = genome_info.inst_hist;
+    hist.Reset(prog.GetInstLib()->GetSize());
+    for (size_t fID = 0; fID < prog.GetSize(); ++fID) hist.AddFunction(prog[fID]);
+    genome_info.inst_entropy = hist.GetEntropy();
+    genome_info.entropy_calculated = true;
     genome_info.calculated = true; 
   }
 
+  /// Does calculated genome information agree with a full recalculation from the program? 
+  bool CheckGenomeInfo() {
+    if (!genome_info.calculated) return true;
+    MapElitesSignalGPOrg fresh(genome);
+    fresh.CalcGenomeInfo();
+    return genome_info.inst_hist == fresh.genome_info.inst_hist && GetInstEntropy() == fresh.GetInstEntropy();
+  }
+
   /// Retrieve genome instruction entropy. If not calculated, calculate.
   double GetInstEntropy() {
     if (!genome_info.calculated) CalcGenomeInfo();
+    if (!genome_info.entropy_calculated) {
+      genome_info.inst_entropy = genome_info.inst_hist.GetEntropy();
+      genome_info.entropy_calculated = true;
+    }
     return genome_info.inst_entropy; 
   }
 
   /// Retrieve genome instruction count. If not calculated, calculate.
   double GetInstCnt() { 
     if (!genome_info.calculated) CalcGenomeInfo();
-    return genome_info.inst_cnt; 
+    return genome_info.inst_hist.GetTotal(); 
   }
 
   /// Retrive function count of genome. 
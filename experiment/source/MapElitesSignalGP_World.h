@@ -1,10 +1,14 @@
 #ifndef MAPE_SIGNALGP_WORLD_H
 #define MAPE_SIGNALGP_WORLD_H
 
+#include <algorithm>
 #include <iostream>
 #include <functional>
 #include <string>
 #include <fstream>
+#include <chrono>
+#include <unordered_map>
+#include <utility>
 #include <sys/stat.h>
 
 
@@ -35,6 +39,14 @@
 #include "TestcaseSet.h"
 #include "TaskSet.h"
 #include "PhenotypeCache.h"
+#include "WorkerPool.h"
+#include "RandomStreams.h"
+#include "GenomeCache.h"
+#include "PopSnapshot.h"
+#include "Checkpoint.h"
+#include "LexicaseSelect.h"
+#include "ProgramMutator.h"
+#include "PhaseTiming.h"
 
 // Major TODOS: 
 // - [ ] More Testing
@@ -50,14 +62,15 @@ public:
   enum class WORLD_MODE { WELL_MIXED=0, MAPE=1 };
   enum class PROBLEM_TYPE { CHG_ENV=0, TESTCASES=1, LOGIC=2 };
   enum class SELECTION_METHOD { TOURNAMENT=0, LEXICASE=1, RANDOM=2 };
+  enum class TESTCASE_SAMPLING { FIXED=0, DOWN_SAMPLE=1, ROTATE=2, STRATIFIED=3 };
   enum class POP_INIT_METHOD { RANDOM=0, ANCESTOR=1 };
   enum class EVAL_TRIAL_AGG_METHOD { MIN=0, MAX=1, AVG=2 }; 
   enum class CHGENV_TAG_GEN_METHOD { RANDOM=0, LOAD=1 }; 
   enum class ENV_CHG_METHOD { SHUFFLE=0, CYCLE=1, RAND=2 };
-  struct OrgPhenotype;
+  enum class EVAL_STREAM { POP=0, OFFSPRING=1, SNAPSHOT=2 };
 
   using org_t = MapElitesSignalGPOrg; 
-  using phenotype_t = OrgPhenotype;
+  using phenotype_t = PhenotypeCache::Phenotype;
   using hardware_t = typename org_t::hardware_t;
   using program_t = typename org_t::program_t;
   using genome_t = typename org_t::genome_t;
@@ -74,57 +87,15 @@ public:
   using mut_fun_t = std::function<size_t(org_t &, emp::Random &)>;
   using score_fun_t = std::function<double(org_t &, phenotype_t &)>;
 
+  static constexpr size_t TAG_WORD_CNT = (org_t::TAG_WIDTH + 31) / 32;
+
   using task_io_t = uint32_t;
   using taskset_t = TaskSet<std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS>, task_io_t>;
 
-  struct OrgPhenotype {
-    // Generic
-    double score;  
-    std::unordered_set<size_t> functions_used_set;
-    emp::vector<size_t> function_entries;           ///< All functions entered (allows repeats), in the order they were entered.
-
-    // For changing environment problem
-    double env_match_score;
-    emp::vector<size_t> matches_by_env;
-    emp::vector<size_t> time_by_env;
-
-    // For testcase problems
-    emp::vector<double> testcase_results;
-
-    // For logic problem
-    size_t task_cnt;
-    size_t time_all_logic_tasks_done;
-    size_t unique_logic_tasks_done;
-    emp::vector<size_t> logic_tasks_done_by_task;
-
-    void SetTaskCnt(size_t val) {
-      task_cnt = val;
-      logic_tasks_done_by_task.resize(task_cnt, 0);
-    }
-
-    void SetEnvCnt(size_t val) {
-      matches_by_env.resize(val, 0);
-      time_by_env.resize(val, 0);
-    }
-
-    void Reset() {
-      score = 0;
-      function_entries.clear();
-      functions_used_set.clear();
-
-      env_match_score = 0;
-      for (size_t i = 0; i < matches_by_env.size(); ++i) matches_by_env[i] = 0;
-      for (size_t i = 0; i < time_by_env.size(); ++i) time_by_env[i] = 0;
-
-      testcase_results.clear();
-
-      time_all_logic_tasks_done = 0;
-      unique_logic_tasks_done = 0;
-      for (size_t i = 0; i < task_cnt; ++i) logic_tasks_done_by_task[i] = 0;
-    }
-  };
-
 protected:
+  struct EvalContext;
+  using eval_ctx_t = EvalContext;
+
   // Localized configurable parameters
   // == General Group ==
   size_t WORLD_STRUCTURE;
@@ -137,6 +108,10 @@ protected:
   size_t EVAL_TRIAL_CNT;
   size_t EVAL_TRIAL_AGG_METHOD;
   size_t EVAL_TIME;
+  size_t EVAL_THREADS;
+  size_t GENOME_CACHE_SIZE;
+  bool EVAL_EARLY_EXIT;
+  bool FIRST_SUBMIT_WINS;
   // == Selection group ==
   size_t SELECTION_METHOD;
   size_t ELITE_CNT;
@@ -150,9 +125,11 @@ protected:
   bool USE_MAPE_AXIS__FUNC_ENTERED_ENTROPY;
   size_t MAPE_AXIS_SIZE__INST_ENTROPY;
   size_t MAPE_AXIS_SIZE__FUNC_ENTERED_ENTROPY;
+  size_t MAPE_BATCH_SIZE;
   // == Problem group ==
   size_t PROBLEM_TYPE;
   std::string TESTCASES_FPATH;
+  bool TESTCASES_CACHE;
   // == Changing environment group ==
   size_t ENV_TAG_GEN_METHOD;
   std::string ENV_TAG_FPATH;
@@ -167,6 +144,9 @@ protected:
   // == Testcase problem group ==
   size_t NUM_TEST_CASES;
   bool SHUFFLE_TEST_CASES;
+  size_t TESTCASE_SAMPLING;
+  // == Logic problem group ==
+  size_t LOGIC_INPUT_POOL_SIZE;
   // == Program constraints group ==
   size_t PROG_MIN_FUNC_CNT;
   size_t PROG_MAX_FUNC_CNT;
@@ -195,26 +175,50 @@ protected:
   size_t SNAPSHOT_INTERVAL;
   size_t DOM_SNAPSHOT_TRIAL_CNT;
   size_t MAP_SNAPSHOT_TRIAL_CNT;
+  size_t POP_SNAPSHOT_FORMAT;
+  bool SNAPSHOT_REUSE_PHENOTYPES;
+  size_t CHECKPOINT_INTERVAL;
+  bool RESUME;
+  bool PHASE_TIMING;
 
-  emp::SignalGPMutator<org_t::TAG_WIDTH> mutator;
-  emp::vector<mut_fun_t> mut_funs;
+  ProgramMutator<org_t::TAG_WIDTH> mutator;
+  emp::vector<mut_fun_t> mut_funs;  ///< Must keep the organism's instruction histogram (if it has one) up to date.
+  size_t birth_parent_id;           ///< Parent of the organism currently being born.
 
   emp::vector<std::function<double(org_t &)>> lexicase_fit_set;
+  ScoreMatrix lexicase_scores;              ///< lexicase_fit_set scores for every organism (filled once per generation).
+  ParallelLexicaseSelector lexicase_selector;  ///< Runs selection events on eval_pool.
+  emp::vector<size_t> lexicase_winners;
+  emp::vector<double> min_testcase_results; ///< Scratch space for FillLexicaseScores (case count per worker).
 
   inst_lib_t inst_lib;
   event_lib_t event_lib;
 
-  emp::Ptr<hardware_t> eval_hw;
+  TestcaseSet<double, double> testcases;
+  emp::vector<size_t> testcase_ids;     ///< Test cases in the order we use them; the first NUM_TEST_CASES are active this generation.
+  emp::vector<emp::vector<size_t>> testcase_strata; ///< Test cases grouped by (sorted) output (only for stratified sampling).
 
-  TestcaseSet<int, double> testcases;
-  emp::vector<size_t> testcase_ids;
+  /// Testcase inputs/outputs, prepared once (at problem setup) in the form that evaluation wants them.
+  struct TestcaseEvalInfo {
+    memory_t input_mem;  ///< Input memory for the main core.
+    double output;       ///< Correct output.
+    double divisor;      ///< Output error gets scaled by this (correct output, truncated; 1 if that's 0).
+  };
+  emp::vector<TestcaseEvalInfo> testcase_eval_info;
 
-  taskset_t task_set;
-  std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS> task_inputs;
-  size_t input_load_id;
+  taskset_t task_set;   ///< Task set prototype (each evaluation context gets its own copy).
+  taskset_t::InputPool logic_input_pool;  ///< Collision-free logic task inputs shared by all evaluation contexts (if LOGIC_INPUT_POOL_SIZE).
 
 
-  PhenotypeCache<OrgPhenotype> phen_cache;  // NOTE: cache is not necessarily accurate for everyone in pop during MAPE
+  PhenotypeCache phen_cache;  // NOTE: cache is not necessarily accurate for everyone in pop during MAPE
+  PhenotypeCache::Layout phen_layout;  ///< Phenotype cache row widths (filled out during problem setup).
+  emp::vector<bool> phen_valid;        ///< Does phen_cache hold up-to-date phenotypes for the organism at each position?
+  const org_t * temp_phen_org;         ///< Which organism (if any) was last evaluated into the spare phen_cache position? (MAPE)
+
+  struct SnapshotInfo {
+    size_t evals_run;     ///< Evaluations run for current snapshot.
+    size_t evals_reused;  ///< Evaluations reused (from phen_cache) for current snapshot.
+  } snapshot_info;
   score_fun_t calc_score;
   std::function<double(org_t &)> agg_scores;
 
@@ -225,8 +229,6 @@ protected:
   std::function<double(org_t &)> func_entered_ent_fun;
   std::function<int(org_t &)> func_cnt_fun;
 
-  size_t eval_time;
-  size_t trial_id;
   double best_score;
   size_t dominant_id; 
 
@@ -258,7 +260,25 @@ protected:
 
   struct PopStatsInfo {
     size_t cur_org_id;
+    size_t cur_phen_id;  ///< Phenotype cache position holding the phenotypes being reported for cur_org_id.
   } pop_snapshot_info;
+
+  /// Max number of evaluations to hold in snapshot_phen_cache at once.
+  static constexpr size_t SNAPSHOT_EVAL_CHUNK = 1024;
+  PhenotypeCache snapshot_phen_cache;     ///< Holds snapshot evaluations (so they don't clobber phen_cache). 
+  emp::vector<size_t> snapshot_jobs;      ///< Snapshot evaluations (in the current chunk) that need to be run.
+  std::ofstream snapshot_timing_ofstream; ///< Wall-clock time spent taking snapshots.
+  PhaseTimer phase_timer;                ///< Wall-clock time spent in each phase of the current update.
+  std::ofstream phase_timing_ofstream;   ///< Phase timing, one row per update (if PHASE_TIMING).
+
+  // == Checkpointing ==
+  std::string checkpoint_fpath;
+  CheckpointFiles ckpt_files;     ///< Output files that pick up where they left off when we resume.
+  CheckpointReader resume_ckpt;   ///< Checkpoint we're resuming from (if resuming).
+  bool resuming;                  ///< Did this run start from a checkpoint?
+  uint64_t run_seed;              ///< Base seed for the world random number stream (reseeded every update when checkpointing).
+  emp::vector<double> fitness_node_vals; ///< Values collected by the fitness data node at the end of the last update.
+  bool mape_dense_select;         ///< Is the MAP full enough to switch from sparse to dense random selection?
   
   // == Problem-specific world info ==
   /// World info relevant to changing environment problem. 
@@ -270,15 +290,81 @@ protected:
       size_t env_state;
       
       void ResetEnv(emp::Random & rnd) { 
+        // Start from a fresh ordering so that the new ordering only depends on rnd. 
+        for (size_t i = 0; i < env_shuffler.size(); ++i) env_shuffler[i] = i;
         emp::Shuffle(rnd, env_shuffler);
         env_shuffle_id=0;
         env_state=(size_t)-1; 
       }
-  } chgenv_info;
+  } chgenv_info;  ///< Changing environment prototype (each evaluation context gets its own copy).
 
   struct TestcaseProblemInfo {
     size_t cur_testcase;
-  } testcase_info;
+    size_t steps_run;  ///< Hardware steps executed on testcases (since last ResetTestcaseStats).
+    size_t cases_run;  ///< Testcases run (since last ResetTestcaseStats).
+  };
+
+  struct LogicProblemInfo {
+    size_t steps_saved; ///< Hardware steps skipped by ending trials once all tasks were credited (since last ResetLogicStats).
+    size_t trials_run;  ///< Logic trials run (since last ResetLogicStats).
+  };
+
+  /// Everything needed to evaluate an organism that cannot be shared by concurrent evaluations.
+  /// We keep one evaluation context per evaluation worker.
+  struct EvalContext {
+    size_t worker_id;
+    emp::Ptr<hardware_t> hw;    ///< Evaluation hardware owned by this worker.
+    emp::Ptr<emp::Random> rnd;  ///< Random number generator used during evaluation (reseeded every trial).
+    emp::Ptr<PhenotypeCache> phens; ///< Phenotype cache that we're writing the evaluation into.
+    size_t trial_id;            ///< Current evaluation trial.
+    size_t eval_time;           ///< Current time step within evaluation trial.
+    size_t phen_id;             ///< Phenotype cache position that we're writing the evaluation into.
+    FunctionEntryCounts func_entries;  ///< Function entries for the current trial (flushed to phenotype at end of trial).
+    // Problem-specific state
+    ChgEnvProblemInfo chgenv_info;
+    TestcaseProblemInfo testcase_info;
+    LogicProblemInfo logic_info;
+    taskset_t task_set;
+    std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS> task_inputs;
+    size_t input_load_id;
+    size_t evals_run;           ///< Non-snapshot evaluations run (since last ResetEvalCnt).
+
+    EvalContext(size_t _id) 
+      : worker_id(_id), hw(nullptr), rnd(nullptr), phens(nullptr),
+        trial_id(0), eval_time(0), phen_id(0), func_entries(), 
+        chgenv_info(), testcase_info{0, 0, 0}, logic_info{0, 0}, task_set(), task_inputs(), input_load_id(0), evals_run(0) { ; }
+  };
+  emp::vector<emp::Ptr<eval_ctx_t>> eval_ctxs;  ///< One evaluation context per worker. 
+  uint64_t eval_seed;                            ///< Base seed for evaluation random number streams.
+  size_t offspring_eval_cnt;                     ///< Number of offspring evaluated this update (MAPE). 
+  emp::vector<size_t> eval_queue;                ///< Population positions that need to be evaluated this update.
+  emp::vector<size_t> eval_hashes;               ///< Genome hashes for organisms in eval_queue. 
+  std::unordered_map<size_t, size_t> eval_firsts; ///< Genome hash => first queued organism (or batch offspring) with it.
+  emp::vector<std::pair<size_t, size_t>> eval_dups; ///< (Position, position of queued organism with the same genome).
+
+  /// Offspring bred for a MAP-Elites batch (MAPE_BATCH_SIZE > 0).
+  /// Offspring i is evaluated into phen_cache row GetSize()+1+i (GetSize() stays the serial temp row).
+  struct MapeBatch {
+    static constexpr size_t NO_EVAL = (size_t)-1;
+    static constexpr size_t NO_SOURCE = (size_t)-1;
+    emp::vector<emp::Ptr<org_t>> orgs;  ///< Offspring (null once placed in the map).
+    emp::vector<size_t> parents;        ///< Position of each offspring's parent.
+    emp::vector<size_t> hashes;         ///< Genome hash of each offspring (if genome caching).
+    emp::vector<size_t> streams;        ///< Evaluation stream index of each offspring (NO_EVAL if it isn't evaluated).
+    emp::vector<size_t> sources;        ///< Earlier offspring with the same genome, evaluated for both (or NO_SOURCE).
+    emp::vector<double> fitness;        ///< Fitness of each offspring.
+    emp::vector<size_t> cells;          ///< Which MAP cell each offspring belongs in.
+    emp::vector<size_t> order;          ///< Offspring sorted by cell (birth order within a cell).
+
+    void Resize(size_t size) {
+      orgs.resize(size, nullptr); parents.resize(size); hashes.resize(size); streams.resize(size); sources.resize(size);
+      fitness.resize(size); cells.resize(size); order.resize(size);
+    }
+  } mape_batch;
+
+  /// Evaluation results (phenotype for every trial) memoized by genome across generations. 
+  GenomeCache<genome_t, PhenotypeCache> genome_cache;
+  WorkerPool eval_pool;                          ///< Worker threads used to evaluate the population.
 
   // Run signals
   emp::Signal<void(void)> do_begin_run_sig; 
@@ -292,22 +378,25 @@ protected:
   // Data-tracking signals
   emp::Signal<void(void)> do_pop_snapshot_sig;
 
-  // Fitness evaluation signals
-  emp::Signal<void(org_t &)> begin_org_eval_sig;  ///< Triggered at beginning of agent evaluation (might be multiple trials)
-  emp::Signal<void(org_t &)> end_org_eval_sig;    ///< Triggered at beginning of agent evaluation (might be multiple trials)
+  // Fitness evaluation signals (may be triggered concurrently from different evaluation workers)
+  emp::Signal<void(org_t &, eval_ctx_t &)> begin_org_eval_sig;  ///< Triggered at beginning of agent evaluation (might be multiple trials)
+  emp::Signal<void(org_t &, eval_ctx_t &)> end_org_eval_sig;    ///< Triggered at beginning of agent evaluation (might be multiple trials)
 
-  emp::Signal<void(org_t &)> begin_org_trial_sig; ///< Triggered at the beginning of an agent trial.
-  emp::Signal<void(org_t &)> do_org_trial_sig;    ///< Triggered at the beginning of an agent trial.
-  emp::Signal<void(org_t &)> end_org_trial_sig;   ///< Triggered at the beginning of an agent trial.
+  emp::Signal<void(org_t &, eval_ctx_t &)> begin_org_trial_sig; ///< Triggered at the beginning of an agent trial.
+  emp::Signal<void(org_t &, eval_ctx_t &)> do_org_trial_sig;    ///< Triggered at the beginning of an agent trial.
+  emp::Signal<void(org_t &, eval_ctx_t &)> end_org_trial_sig;   ///< Triggered at the beginning of an agent trial.
 
-  emp::Signal<void(org_t &)> do_org_advance_sig;  ///< When triggered, advance SignalGP evaluation hardware
-  emp::Signal<void(void)> do_env_advance_sig;         ///< When triggered, advance the environment by one step
+  emp::Signal<void(org_t &, eval_ctx_t &)> do_org_advance_sig;  ///< When triggered, advance SignalGP evaluation hardware
+  emp::Signal<void(eval_ctx_t &)> do_env_advance_sig;           ///< When triggered, advance the environment by one step
 
   // === Configuration functions ===
   void Init_Configs(MapElitesGPConfig & config);
+  void Init_Checkpointing();
   void Init_Problem();
   void Init_Mutator();
   void Init_Hardware();
+  void Init_EvalContexts();
+  void Init_GenomeCache();
   void Init_WorldMode();
 
   void SetupProblem_ChgEnv();
@@ -328,6 +417,12 @@ protected:
   // === Data collection/tracking functions ===
   /// Snapshot all programs for current update.
   void Snapshot_Programs();
+
+  /// Snapshot all programs for current update in text format (.pop).
+  void Snapshot_ProgramsText(const std::string & fpath);
+
+  /// Snapshot all programs for current update in binary format (.popb; see PopSnapshot.h).
+  void Snapshot_ProgramsBinary(const std::string & fpath);
   
   /// Snapshot population statistics for current update.
   void Snapshot_PopulationStats();
@@ -341,40 +436,222 @@ protected:
   /// Add a data file to track dominant program. Will track at same interval as fitness file. (only makes sense in context of non-MAPE run).
   emp::DataFile & AddDominantFile(const std::string & fpath);
 
+  // === Checkpoint functions ===
+  /// Write out everything needed to resume this run from the current update.
+  void SaveCheckpoint();
+
+  /// Restore world state from resume_ckpt (after begin-run setup, in place of population initialization).
+  void RestoreCheckpoint();
+
+  void SaveTags(CheckpointWriter & ckpt, const emp::vector<tag_t> & tags) {
+    ckpt.Put((uint64_t)tags.size());
+    for (const tag_t & tag : tags) {
+      for (size_t i = 0; i < TAG_WORD_CNT; ++i) ckpt.Put((uint32_t)tag.GetUInt(i));
+    }
+  }
+
+  void LoadTags(CheckpointReader & ckpt, emp::vector<tag_t> & tags) {
+    const uint64_t cnt = ckpt.Get<uint64_t>();
+    tags.clear();
+    for (size_t t = 0; t < cnt && ckpt.IsOK(); ++t) {
+      tags.emplace_back();
+      for (size_t i = 0; i < TAG_WORD_CNT; ++i) tags.back().SetUInt(i, ckpt.Get<uint32_t>());
+    }
+  }
+
+  void SaveGenome(CheckpointWriter & ckpt, genome_t & genome);
+  bool LoadGenome(CheckpointReader & ckpt, program_t & prog, double & sim_thresh);
+
   // === Logic task problem utility functions ===
-  /// Reset logic tasks, guaranteeing no solution collisions among the tasks.
-  void ResetTasks() {
-    input_load_id = 0;
-    task_inputs[0] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-    task_inputs[1] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-    task_set.SetInputs(task_inputs);
-    while (task_set.IsCollision()) {
-      task_inputs[0] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-      task_inputs[1] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
-      task_set.SetInputs(task_inputs);
+  /// Reset logic tasks (in given evaluation context), guaranteeing no solution collisions among the tasks.
+  void ResetTasks(eval_ctx_t & ctx) {
+    ctx.input_load_id = 0;
+    if (logic_input_pool.GetSize()) {
+      const size_t id = ctx.rnd->GetUInt(logic_input_pool.GetSize());
+      ctx.task_inputs = logic_input_pool.GetInputs(id);
+      ctx.task_set.SetPooledInputs(logic_input_pool, id);
+      return;
+    }
+    ctx.task_inputs[0] = ctx.rnd->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+    ctx.task_inputs[1] = ctx.rnd->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+    ctx.task_set.SetInputs(ctx.task_inputs);
+    while (ctx.task_set.IsCollision()) {
+      ctx.task_inputs[0] = ctx.rnd->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+      ctx.task_inputs[1] = ctx.rnd->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+      ctx.task_set.SetInputs(ctx.task_inputs);
     }
   }
 
   // === Eval hardware utility functions ===
-  void ResetEvalHW() {
-    eval_hw->ResetHardware();
+  void ResetEvalHW(eval_ctx_t & ctx) {
+    ctx.hw->ResetHardware();
     // TODO: add signal for onreset hardware
-    eval_hw->SetTrait(trait_id_t::ORG_ID, -1);
-    eval_hw->SetTrait(trait_id_t::PROBLEM_OUTPUT, -1);
-    eval_hw->SetTrait(trait_id_t::ORG_STATE, -1);
-    eval_hw->SetTrait(trait_id_t::OUTPUT_SET, 0);
+    ctx.hw->SetTrait(trait_id_t::ORG_ID, -1);
+    ctx.hw->SetTrait(trait_id_t::PROBLEM_OUTPUT, -1);
+    ctx.hw->SetTrait(trait_id_t::ORG_STATE, -1);
+    ctx.hw->SetTrait(trait_id_t::OUTPUT_SET, 0);
+    ctx.hw->SetTrait(trait_id_t::WORKER_ID, ctx.worker_id);
+  }
+
+  /// Reset evaluation hardware between testcases (within a trial).
+  /// Testcase evaluation only ever writes the output traits; everything else was set up by ResetEvalHW at the start of the trial.
+  void ResetEvalHWForTestcase(eval_ctx_t & ctx) {
+    ctx.hw->ResetHardware();
+    ctx.hw->SetTrait(trait_id_t::PROBLEM_OUTPUT, -1);
+    ctx.hw->SetTrait(trait_id_t::OUTPUT_SET, 0);
+  }
+
+  /// Can the outcome of the current testcase still change? Testcases never dispatch events, so once there are 
+  /// no active (or pending) threads, nothing else will run.
+  bool IsTestcaseSettled(eval_ctx_t & ctx) {
+    if (FIRST_SUBMIT_WINS && (bool)ctx.hw->GetTrait(trait_id_t::OUTPUT_SET)) return true;
+    return ctx.hw->GetActiveCores().empty() && ctx.hw->GetPendingCores().empty();
+  }
+
+  /// Average number of hardware steps actually executed per testcase (across all workers) since the last reset.
+  double GetTestcaseStepsPerCase() const {
+    size_t steps = 0, cases = 0;
+    for (size_t i = 0; i < eval_ctxs.size(); ++i) {
+      steps += eval_ctxs[i]->testcase_info.steps_run;
+      cases += eval_ctxs[i]->testcase_info.cases_run;
+    }
+    return (cases) ? steps / (double)cases : 0.0;
+  }
+
+  void ResetTestcaseStats() {
+    for (size_t i = 0; i < eval_ctxs.size(); ++i) {
+      eval_ctxs[i]->testcase_info.steps_run = 0;
+      eval_ctxs[i]->testcase_info.cases_run = 0;
+    }
+  }
+
+  /// Average number of hardware steps per logic trial (across all workers) skipped by early exit since the last reset.
+  double GetLogicStepsSavedPerTrial() const {
+    size_t saved = 0, trials = 0;
+    for (size_t i = 0; i < eval_ctxs.size(); ++i) {
+      saved += eval_ctxs[i]->logic_info.steps_saved;
+      trials += eval_ctxs[i]->logic_info.trials_run;
+    }
+    return (trials) ? saved / (double)trials : 0.0;
+  }
+
+  /// Materialize lexicase_fit_set scores for the whole population (case-major; see ScoreMatrix), one org per job.
+  /// Testcase scores come straight from the phenotype cache; other problems go through lexicase_fit_set once per org.
+  /// Results that aren't finite numbers get the empty score (see ScoreMatrix::ToScore).
+  void FillLexicaseScores() {
+    const size_t case_cnt = lexicase_fit_set.size();
+    lexicase_scores.Resize(case_cnt, GetSize());
+    const bool testcases_direct = PROBLEM_TYPE == (size_t)PROBLEM_TYPE::TESTCASES 
+                                  && case_cnt == phen_cache.GetLayout().testcase_cnt;
+    if (testcases_direct) min_testcase_results.resize(case_cnt * eval_pool.GetSize());
+    eval_pool.Run(GetSize(), [this, case_cnt, testcases_direct](size_t worker_id, size_t org_id) {
+      if (!IsOccupied(org_id)) {
+        for (size_t c = 0; c < case_cnt; ++c) lexicase_scores.Get(c, org_id) = ScoreMatrix::GetEmptyScore();
+      } else if (testcases_direct) {
+        double * results = min_testcase_results.data() + worker_id * case_cnt;
+        phen_cache.GetMinTestcaseResults(org_id, results);
+        for (size_t c = 0; c < case_cnt; ++c) lexicase_scores.Get(c, org_id) = ScoreMatrix::ToScore(results[c]);
+      } else {
+        org_t & org = GetOrg(org_id);
+        for (size_t c = 0; c < case_cnt; ++c) lexicase_scores.Get(c, org_id) = ScoreMatrix::ToScore(lexicase_fit_set[c](org));
+      }
+    });
+  }
+
+  void ResetLogicStats() {
+    for (size_t i = 0; i < eval_ctxs.size(); ++i) {
+      eval_ctxs[i]->logic_info.steps_saved = 0;
+      eval_ctxs[i]->logic_info.trials_run = 0;
+    }
+  }
+
+  /// Number of (non-snapshot) evaluations run (across all workers) since the last reset.
+  size_t GetEvalCnt() const {
+    size_t evals = 0;
+    for (size_t i = 0; i < eval_ctxs.size(); ++i) evals += eval_ctxs[i]->evals_run;
+    return evals;
+  }
+
+  void ResetEvalCnt() {
+    for (size_t i = 0; i < eval_ctxs.size(); ++i) eval_ctxs[i]->evals_run = 0;
+  }
+
+  /// Get the evaluation context that is running the given hardware. 
+  eval_ctx_t & GetEvalCtx(hardware_t & hw) {
+    return *eval_ctxs[(size_t)hw.GetTrait(trait_id_t::WORKER_ID)];
   }
 
   // === Evaluation functions ===
-  /// Evaluate given agent.
-  void Evaluate(org_t & org) {
-    begin_org_eval_sig.Trigger(org);  //? Can I keep trial ID local? 
-    for (trial_id = 0; trial_id < EVAL_TRIAL_CNT; ++trial_id) {
-      begin_org_trial_sig.Trigger(org);
-      do_org_trial_sig.Trigger(org);
-      end_org_trial_sig.Trigger(org);
+  /// Evaluate given agent using the given evaluation context, storing its phenotype in row phen_id of phens.
+  /// Every trial draws its randomness from its own stream, named by (seed, update, stream_pos, trial, stream, stream_idx). 
+  /// So, results only depend on the stream name: not on evaluation order or on which worker did the evaluating.
+  /// Safe to call concurrently as long as each call uses a different context and phenotype cache row.
+  void EvaluateInto(org_t & org, eval_ctx_t & ctx, PhenotypeCache & phens, size_t phen_id, size_t stream_pos, 
+                    EVAL_STREAM stream=EVAL_STREAM::POP, size_t stream_idx=0) {
+    ctx.phens = &phens;
+    ctx.phen_id = phen_id;
+    // If we're caching evaluations by genome, (non-snapshot) evaluation must be a pure function of the genome.
+    const bool genome_keyed = genome_cache.IsActive() && stream != EVAL_STREAM::SNAPSHOT;
+    const size_t genome_hash = (genome_keyed) ? org.GetGenome().Hash() : 0;
+    begin_org_eval_sig.Trigger(org, ctx);
+    for (ctx.trial_id = 0; ctx.trial_id < EVAL_TRIAL_CNT; ++ctx.trial_id) {
+      if (genome_keyed) {
+        ctx.rnd->ResetSeed(DeriveStreamSeed(eval_seed, {(uint64_t)genome_hash, (uint64_t)ctx.trial_id}));
+      } else {
+        ctx.rnd->ResetSeed(DeriveStreamSeed(eval_seed, {(uint64_t)GetUpdate(), (uint64_t)stream_pos, (uint64_t)ctx.trial_id, 
+                                                        (uint64_t)stream, (uint64_t)stream_idx}));
+      }
+      ctx.func_entries.Reset();
+      begin_org_trial_sig.Trigger(org, ctx);
+      do_org_trial_sig.Trigger(org, ctx);
+      ctx.phens->Get(ctx.phen_id, ctx.trial_id).SetFunctionEntries(ctx.func_entries);
+      end_org_trial_sig.Trigger(org, ctx);
     }
-    end_org_eval_sig.Trigger(org);
+    end_org_eval_sig.Trigger(org, ctx);
+    if (stream != EVAL_STREAM::SNAPSHOT) ++ctx.evals_run;
+  }
+
+  /// Evaluate given agent using the given evaluation context (phenotype goes in the agent's position in the cache).
+  void Evaluate(org_t & org, eval_ctx_t & ctx, EVAL_STREAM stream=EVAL_STREAM::POP, size_t stream_idx=0) {
+    EvaluateInto(org, ctx, phen_cache, org.GetPos(), org.GetPos(), stream, stream_idx);
+  }
+
+  /// Evaluate given agent on the main thread. 
+  void Evaluate(org_t & org, EVAL_STREAM stream=EVAL_STREAM::POP, size_t stream_idx=0) { 
+    Evaluate(org, *eval_ctxs[0], stream, stream_idx); 
+  }
+
+  /// Evaluate the entire population (using all evaluation workers), skipping organisms whose genomes are cached.
+  void EvaluatePopulation();
+
+  /// Breed, evaluate (using all evaluation workers), and place a batch of batch_size MAP-Elites offspring.
+  void DoMapeBatch(size_t batch_size);
+
+  /// Do the evaluations needed for a snapshot, writing a line to file for each one. 
+  void SnapshotEvaluations(emp::DataFile & file, const emp::vector<size_t> & org_ids, size_t eval_cnt, size_t & evalID);
+
+  /// Record how long a snapshot took (in snapshot_timing.csv).
+  void RecordSnapshotTiming(const std::string & snapshot, const std::chrono::steady_clock::time_point & start) {
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    snapshot_timing_ofstream << GetUpdate() << "," << snapshot << "," << secs << "," 
+                             << snapshot_info.evals_run << "," << snapshot_info.evals_reused << std::endl;
+    snapshot_info.evals_run = 0;
+    snapshot_info.evals_reused = 0;
+  }
+
+  /// Flag every phenotype in phen_cache as stale.
+  void InvalidatePhenotypes() { for (size_t i = 0; i < phen_valid.size(); ++i) phen_valid[i] = false; }
+
+  /// Copy all of the trial phenotypes for phenotype cache row phen_id. 
+  PhenotypeCache SavePhenotypes(size_t phen_id) {
+    PhenotypeCache phens(1, EVAL_TRIAL_CNT, phen_cache.GetLayout());
+    phens.CopyOrg(0, phen_cache, phen_id);
+    return phens;
+  }
+
+  /// Overwrite all of the trial phenotypes for phenotype cache row phen_id. 
+  void LoadPhenotypes(size_t phen_id, const PhenotypeCache & phens) {
+    phen_cache.CopyOrg(phen_id, phens, 0);
   }
 
   /// Used to poke the world as I develop it. 
@@ -389,7 +666,12 @@ public:
   MapElitesSignalGPWorld() : emp::World<org_t>() { ; }
   MapElitesSignalGPWorld(emp::Random & rnd) : emp::World<org_t>(rnd) { ; }
   ~MapElitesSignalGPWorld() {
-    eval_hw.Delete(); // Clean up evaluation hardware. 
+    // Clean up evaluation contexts (and their hardware). 
+    for (size_t i = 0; i < eval_ctxs.size(); ++i) {
+      eval_ctxs[i]->hw.Delete();
+      eval_ctxs[i]->rnd.Delete();
+      eval_ctxs[i].Delete();
+    }
   }
 
   // === Configuration/setup functions ===
@@ -411,6 +693,7 @@ void MapElitesSignalGPWorld::Setup(MapElitesGPConfig & config) {
   Reset();              // Reset the world
   SetCache();           // We'll be caching fitness scores
   Init_Configs(config); // Initialize configs
+  Init_Checkpointing(); // Pick up checkpoint (if resuming); must happen before anything draws random numbers.
 
   // Setup 
   do_begin_run_sig.AddAction([this]() {
@@ -470,44 +753,45 @@ void MapElitesSignalGPWorld::Setup(MapElitesGPConfig & config) {
     if (update % SNAPSHOT_INTERVAL == 0) do_pop_snapshot_sig.Trigger();
     Update(); 
     ClearCache();
+    genome_cache.ResetStats();
+    ResetTestcaseStats();
+    ResetLogicStats();
   });
 
   // Generic evaluation signal actions. 
   // - At beginning of agent evaluation. 
-  begin_org_eval_sig.AddAction([this](org_t & org) {
-    eval_hw->SetProgram(org.GetProgram());
-    pop_snapshot_info.cur_org_id = org.GetPos();
+  begin_org_eval_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    ctx.hw->SetProgram(org.GetProgram());
   });
   
   // Setup evaluation trial signals
   // - Begin trial
-  begin_org_trial_sig.AddAction([this](org_t & org) {
+  begin_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
     // Reset hardware.
-    ResetEvalHW(); 
+    ResetEvalHW(ctx); 
     // Reset phenotype
-    phen_cache.Get(org.GetPos(), trial_id).Reset();
+    ctx.phens->Get(ctx.phen_id, ctx.trial_id).Reset();
     // Set org ID in hardware.
-    eval_hw->SetTrait(trait_id_t::ORG_ID, org.GetPos());
+    ctx.hw->SetTrait(trait_id_t::ORG_ID, ctx.phen_id);
   });
   // - Do trial
-  do_org_trial_sig.AddAction([this](org_t & org) {
-    for (eval_time = 0; eval_time < EVAL_TIME; ++eval_time) {
+  do_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    for (ctx.eval_time = 0; ctx.eval_time < EVAL_TIME; ++ctx.eval_time) {
       // 1) Advance environment.
-      do_env_advance_sig.Trigger();
+      do_env_advance_sig.Trigger(ctx);
       // 2) Advance agent.
-      do_org_advance_sig.Trigger(org);
+      do_org_advance_sig.Trigger(org, ctx);
     }
   });
   // - End trial
-  end_org_trial_sig.AddAction([this](org_t & org) {
-    const size_t id = org.GetPos();
-    phenotype_t & phen = phen_cache.Get(id, trial_id); 
+  end_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    phenotype_t phen = ctx.phens->Get(ctx.phen_id, ctx.trial_id); 
     phen.score = calc_score(org, phen);
   });
 
   // Setup organism advance signal. 
-  do_org_advance_sig.AddAction([this](org_t & org) {
-    eval_hw->SingleProcess();
+  do_org_advance_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    ctx.hw->SingleProcess();
   });
 
   // Setup descriptive functions used by MAP-Elites (and data tracking, etc). 
@@ -517,17 +801,16 @@ void MapElitesSignalGPWorld::Setup(MapElitesGPConfig & config) {
   func_cnt_fun = [](org_t & org) { return org.GetFunctionCnt(); };
   // - Based on program execution 
   func_used_fun = [this](org_t & org) {
+    const size_t * used_cnts = phen_cache.GetFunctionsUsedCnts(org.GetPos());
     double total = 0;
-    for (size_t t = 0; t < EVAL_TRIAL_CNT; ++t) {
-      total += phen_cache.Get(org.GetPos(), t).functions_used_set.size();
-    }
+    for (size_t t = 0; t < EVAL_TRIAL_CNT; ++t) total += used_cnts[t];
     return total / EVAL_TRIAL_CNT;
   };
 
   func_entered_cnt_fun = [this](org_t & org) {
     double total = 0;
     for (size_t t = 0; t < EVAL_TRIAL_CNT; ++t) {
-      total += phen_cache.Get(org.GetPos(), t).function_entries.size();
+      total += phen_cache.Get(org.GetPos(), t).functions_entered_cnt;
     }
     return total / EVAL_TRIAL_CNT;
   };
@@ -535,7 +818,7 @@ void MapElitesSignalGPWorld::Setup(MapElitesGPConfig & config) {
   func_entered_ent_fun = [this](org_t & org) {
     double total = 0; 
     for (size_t t = 0; t < EVAL_TRIAL_CNT; ++t) {
-      total += emp::ShannonEntropy(phen_cache.Get(org.GetPos(), t).function_entries);
+      total += phen_cache.Get(org.GetPos(), t).GetFunctionEntryEntropy();
     }
     return total / EVAL_TRIAL_CNT;
   };
@@ -547,22 +830,67 @@ void MapElitesSignalGPWorld::Setup(MapElitesGPConfig & config) {
     org.SetPos(pos);
   });
   
-  Init_Mutator();       // Configure SignalGPMutator, mutation function.
+  Init_Mutator();       // Configure ProgramMutator, mutation function.
   Init_Hardware();      // Configure SignalGP hardware. 
+  Init_EvalContexts();  // Configure evaluation contexts (one per evaluation worker).
   Init_Problem();       // Configure problem.
+  Init_GenomeCache();   // Configure genome-keyed evaluation cache (needs to know problem).
   Init_WorldMode();      // Configure run (MAP-Eltes vs. Well-mixed population (standard evolutionary algorithm), etc)
   
   #ifndef EMSCRIPTEN
   // Make a data directory. 
   mkdir(DATA_DIRECTORY.c_str(), ACCESSPERMS);
-  if (DATA_DIRECTORY.back() != '/') DATA_DIRECTORY += '/';
 
   // Setup generic snapshots. 
-  do_pop_snapshot_sig.AddAction([this]() { this->Snapshot_Programs(); });
-  do_pop_snapshot_sig.AddAction([this]() { this->Snapshot_PopulationStats(); });
+  ckpt_files.Open(snapshot_timing_ofstream, DATA_DIRECTORY + "snapshot_timing.csv");
+  if (!resuming) snapshot_timing_ofstream << "update,snapshot,wall_time_sec,evals_run,evals_reused" << std::endl;
+  snapshot_info.evals_run = 0;
+  snapshot_info.evals_reused = 0;
+  if (PHASE_TIMING) {
+    const std::string phase_timing_fpath = DATA_DIRECTORY + "phase_timing.csv";
+    ckpt_files.Open(phase_timing_ofstream, phase_timing_fpath);
+    if (!ckpt_files.IsResuming(phase_timing_fpath)) phase_timer.PrintHeader(phase_timing_ofstream);
+  }
+  do_pop_snapshot_sig.AddAction([this]() { 
+    auto start = std::chrono::steady_clock::now();
+    this->Snapshot_Programs(); 
+    RecordSnapshotTiming("programs", start);
+  });
+  do_pop_snapshot_sig.AddAction([this]() { 
+    auto start = std::chrono::steady_clock::now();
+    this->Snapshot_PopulationStats(); 
+    RecordSnapshotTiming("population", start);
+  });
   
-  // Setup fitness tracking. 
-  SetupFitnessFile(DATA_DIRECTORY + "fitness.csv").SetTimingRepeat(STATISTICS_INTERVAL);
+  // Setup fitness tracking (same columns as World::SetupFitnessFile, but resumable). 
+  const std::string fit_fpath = DATA_DIRECTORY + "fitness.csv";
+  emp::DataFile & fit_file = AddDataFile(ckpt_files.OpenDataFile(fit_fpath));
+  auto & fit_node = GetFitnessDataNode();
+  fit_file.AddVar(update, "update", "Update");
+  fit_file.AddMean(fit_node, "mean_fitness", "Average organism fitness in current population.");
+  fit_file.AddMin(fit_node, "min_fitness", "Minimum organism fitness in current population.");
+  fit_file.AddMax(fit_node, "max_fitness", "Maximum organism fitness in current population.");
+  fit_file.AddInferiority(fit_node, "inferiority", "Average fitness / maximum fitness in current population.");
+  if (CHECKPOINT_INTERVAL) {
+    // The fitness node is filled out at the end of every update (after it's been filled, every fitness is cached);
+    // remember what went in so we can refill it on resume.
+    OnUpdate([this](size_t) {
+      fitness_node_vals.clear();
+      for (size_t id = 0; id < GetSize(); ++id) {
+        if (IsOccupied(id)) fitness_node_vals.emplace_back(GetCache(id));
+      }
+    });
+  }
+  fit_file.AddFun(std::function<size_t()>([this]() { return genome_cache.GetHitCnt(); }), "genome_cache_hits", "Evaluations skipped this update because genome was cached.");
+  fit_file.AddFun(std::function<size_t()>([this]() { return genome_cache.GetMissCnt(); }), "genome_cache_misses", "Genome cache lookups this update that required an evaluation.");
+  if (PROBLEM_TYPE == (size_t)PROBLEM_TYPE::TESTCASES) {
+    fit_file.AddFun(std::function<double()>([this]() { return GetTestcaseStepsPerCase(); }), "testcase_steps_per_case", "Average hardware steps executed per testcase this update (less than EVAL_TIME with EVAL_EARLY_EXIT).");
+  }
+  if (PROBLEM_TYPE == (size_t)PROBLEM_TYPE::LOGIC) {
+    fit_file.AddFun(std::function<double()>([this]() { return GetLogicStepsSavedPerTrial(); }), "logic_steps_saved_per_trial", "Average hardware steps per trial skipped this update by ending trials once all tasks were credited (EVAL_EARLY_EXIT).");
+  }
+  if (!ckpt_files.IsResuming(fit_fpath)) fit_file.PrintHeaderKeys();
+  fit_file.SetTimingRepeat(STATISTICS_INTERVAL);
 
   // Setup population statistics TODO: fill out descriptions
   pop_snapshot_stats.emplace_back("update", [this]() { return GetUpdate(); }, "Current world update (generation).");  
@@ -575,6 +903,14 @@ void MapElitesSignalGPWorld::Setup(MapElitesGPConfig & config) {
   pop_snapshot_stats.emplace_back("func_used", [this]() { return func_used_fun(GetOrg(pop_snapshot_info.cur_org_id)); }, "");
   pop_snapshot_stats.emplace_back("func_entered", [this]() { return func_entered_cnt_fun(GetOrg(pop_snapshot_info.cur_org_id)); }, "");
   pop_snapshot_stats.emplace_back("func_entered_entropy", [this]() { return func_entered_ent_fun(GetOrg(pop_snapshot_info.cur_org_id)); }, "");
+  if (PROBLEM_TYPE == (size_t)PROBLEM_TYPE::TESTCASES) {
+    pop_snapshot_stats.emplace_back("testcase_steps", [this]() { 
+      const size_t phen_id = GetOrg(pop_snapshot_info.cur_org_id).GetPos();
+      double total = 0;
+      for (size_t t = 0; t < EVAL_TRIAL_CNT; ++t) total += phen_cache.Get(phen_id, t).GetTestcaseStepTotal();
+      return total / (EVAL_TRIAL_CNT * NUM_TEST_CASES);
+    }, "Average hardware steps executed per testcase.");
+  }
   
   do_begin_run_sig.AddAction([this]() {
     // for each phenotype, add pop snapshot stats thing
@@ -592,32 +928,27 @@ void MapElitesSignalGPWorld::Setup(MapElitesGPConfig & config) {
   switch (EVAL_TRIAL_AGG_METHOD) {
     case (size_t)EVAL_TRIAL_AGG_METHOD::MIN: {
       agg_scores = [this](org_t & org) {
-        double score = phen_cache.Get(org.GetPos(), 0).score;
-        for (size_t tID = 1; tID < EVAL_TRIAL_CNT; ++tID) {
-          double other_score = phen_cache.Get(org.GetPos(), tID).score;
-          if (other_score < score) score = other_score;
-        }
+        const double * scores = phen_cache.GetScores(org.GetPos());
+        double score = scores[0];
+        for (size_t tID = 1; tID < EVAL_TRIAL_CNT; ++tID) score = std::min(score, scores[tID]);
         return score;
       };
       break;
     }
     case (size_t)EVAL_TRIAL_AGG_METHOD::MAX: {
       agg_scores = [this](org_t & org) {
-        double score = phen_cache.Get(org.GetPos(), 0).score;
-        for (size_t tID = 1; tID < EVAL_TRIAL_CNT; ++tID) {
-          double other_score = phen_cache.Get(org.GetPos(), tID).score;
-          if (other_score > score) score = other_score;
-        }
+        const double * scores = phen_cache.GetScores(org.GetPos());
+        double score = scores[0];
+        for (size_t tID = 1; tID < EVAL_TRIAL_CNT; ++tID) score = std::max(score, scores[tID]);
         return score;
       };
       break;
     }
     case (size_t)EVAL_TRIAL_AGG_METHOD::AVG: {
       agg_scores = [this](org_t & org) {
-        double agg_score = phen_cache.Get(org.GetPos(), 0).score;
-        for (size_t tID = 1; tID < EVAL_TRIAL_CNT; ++tID) {
-          agg_score += phen_cache.Get(org.GetPos(), tID).score;
-        }
+        const double * scores = phen_cache.GetScores(org.GetPos());
+        double agg_score = scores[0];
+        for (size_t tID = 1; tID < EVAL_TRIAL_CNT; ++tID) agg_score += scores[tID];
         return agg_score / EVAL_TRIAL_CNT;
 
       };
@@ -661,6 +992,10 @@ void MapElitesSignalGPWorld::Init_Configs(MapElitesGPConfig & config) {
   EVAL_TRIAL_CNT = config.EVAL_TRIAL_CNT();
   EVAL_TRIAL_AGG_METHOD = config.EVAL_TRIAL_AGG_METHOD();
   EVAL_TIME = config.EVAL_TIME();
+  EVAL_THREADS = config.EVAL_THREADS();
+  GENOME_CACHE_SIZE = config.GENOME_CACHE_SIZE();
+  EVAL_EARLY_EXIT = config.EVAL_EARLY_EXIT();
+  FIRST_SUBMIT_WINS = config.FIRST_SUBMIT_WINS();
 
   SELECTION_METHOD = config.SELECTION_METHOD();
   ELITE_CNT = config.ELITE_CNT();
@@ -674,9 +1009,11 @@ void MapElitesSignalGPWorld::Init_Configs(MapElitesGPConfig & config) {
   USE_MAPE_AXIS__FUNC_ENTERED_ENTROPY = config.USE_MAPE_AXIS__FUNC_ENTERED_ENTROPY();
   MAPE_AXIS_SIZE__INST_ENTROPY = config.MAPE_AXIS_SIZE__INST_ENTROPY();
   MAPE_AXIS_SIZE__FUNC_ENTERED_ENTROPY = config.MAPE_AXIS_SIZE__FUNC_ENTERED_ENTROPY();
+  MAPE_BATCH_SIZE = config.MAPE_BATCH_SIZE();
 
   PROBLEM_TYPE = config.PROBLEM_TYPE();
   TESTCASES_FPATH = config.TESTCASES_FPATH();
+  TESTCASES_CACHE = config.TESTCASES_CACHE();
 
   ENV_TAG_GEN_METHOD = config.ENV_TAG_GEN_METHOD();
   ENV_TAG_FPATH = config.ENV_TAG_FPATH();
@@ -691,6 +1028,8 @@ void MapElitesSignalGPWorld::Init_Configs(MapElitesGPConfig & config) {
 
   NUM_TEST_CASES = config.NUM_TEST_CASES();
   SHUFFLE_TEST_CASES = config.SHUFFLE_TEST_CASES();
+  TESTCASE_SAMPLING = config.TESTCASE_SAMPLING();
+  LOGIC_INPUT_POOL_SIZE = config.LOGIC_INPUT_POOL_SIZE();
 
   PROG_MIN_FUNC_CNT = config.PROG_MIN_FUNC_CNT();
   PROG_MAX_FUNC_CNT = config.PROG_MAX_FUNC_CNT();
@@ -719,6 +1058,13 @@ void MapElitesSignalGPWorld::Init_Configs(MapElitesGPConfig & config) {
   SNAPSHOT_INTERVAL = config.SNAPSHOT_INTERVAL();
   DOM_SNAPSHOT_TRIAL_CNT = config.DOM_SNAPSHOT_TRIAL_CNT();
   MAP_SNAPSHOT_TRIAL_CNT = config.MAP_SNAPSHOT_TRIAL_CNT();
+  POP_SNAPSHOT_FORMAT = config.POP_SNAPSHOT_FORMAT();
+  SNAPSHOT_REUSE_PHENOTYPES = config.SNAPSHOT_REUSE_PHENOTYPES();
+  CHECKPOINT_INTERVAL = config.CHECKPOINT_INTERVAL();
+  RESUME = config.RESUME();
+  PHASE_TIMING = config.PHASE_TIMING();
+
+  if (DATA_DIRECTORY.back() != '/') DATA_DIRECTORY += '/';
 
   // Verify any config constraints
   if (EVAL_TRIAL_CNT < 1) {
@@ -726,12 +1072,46 @@ void MapElitesSignalGPWorld::Init_Configs(MapElitesGPConfig & config) {
     exit(-1);
   }
 
+  if (EVAL_THREADS < 1) {
+    std::cout << "Cannot run experiment with EVAL_THREADS < 1. Exiting..." << std::endl;
+    exit(-1);
+  }
+
   if (ENV_STATE_CNT == (size_t)-1) {
     std::cout << "ENV_STATE_CNT exceeds maximum allowed! Exiting..." << std::endl;
     exit(-1);
   }
 }
 
+/// Initialize checkpointing. If we're resuming, load the checkpoint and pick up its random number seed/update.
+/// (The rest of the checkpoint gets restored at the beginning of the run; see RestoreCheckpoint.)
+void MapElitesSignalGPWorld::Init_Checkpointing() {
+  checkpoint_fpath = DATA_DIRECTORY + "checkpoint.ckpt";
+  run_seed = (uint64_t)random_ptr->GetSeed();
+  resuming = false;
+  mape_dense_select = false;
+  if (!RESUME) return;
+  if (!resume_ckpt.Load(checkpoint_fpath, CHECKPOINT_KIND::SIGNALGP)) {
+    if (std::ifstream(checkpoint_fpath).good()) {
+      std::cout << "Failed to load checkpoint (" << checkpoint_fpath << "). Exiting..." << std::endl;
+      exit(-1);
+    }
+    std::cout << "No checkpoint to resume from (" << checkpoint_fpath << "); starting from scratch." << std::endl;
+    return;
+  }
+  run_seed = resume_ckpt.Get<uint64_t>();
+  update = (size_t)resume_ckpt.Get<uint64_t>();
+  ckpt_files.Load(resume_ckpt);
+  if (!resume_ckpt.IsOK()) {
+    std::cout << "Failed to load checkpoint (" << checkpoint_fpath << "). Exiting..." << std::endl;
+    exit(-1);
+  }
+  // Everything downstream (e.g., evaluation seeds, changing environment tags) is derived from the run seed. 
+  random_ptr->ResetSeed((int)run_seed);
+  resuming = true;
+  std::cout << "Resuming from checkpoint (" << checkpoint_fpath << ") at update " << update << "." << std::endl;
+}
+
 /// Initialize world mutator.
 void MapElitesSignalGPWorld::Init_Mutator() {
   // We'll use the default mutator set. 
@@ -754,17 +1134,23 @@ void MapElitesSignalGPWorld::Init_Mutator() {
   mutator.TAG_BIT_FLIP__PER_BIT(TAG_BIT_FLIP__PER_BIT);
   // Hook up mutator to world's MutateFun
   mut_funs.push_back([this](org_t & org, emp::Random & r) {
-                        return mutator.ApplyMutations(org.GetProgram(), r);
+                        return mutator.ApplyMutations(org.GetProgram(), r, org.GetInstHistogram());
                       });
 
   SetMutFun([this](org_t & org, emp::Random & r) {
-    org.ResetGenomeInfo();
     size_t mut_cnt = 0; 
     for (size_t f = 0; f < mut_funs.size(); ++f) {
       mut_cnt += mut_funs[f](org, r);
     }
+    if (mut_cnt) org.ResetInstEntropy();
     return mut_cnt;
   });
+
+  // Offspring start out with their parent's genome info (mutations then apply their changes to it). 
+  // Registered before any world mode turns on auto-mutation, so it happens before offspring are mutated.
+  birth_parent_id = 0;
+  OnBeforeRepro([this](size_t parent_id) { birth_parent_id = parent_id; });
+  OnOffspringReady([this](org_t & org) { org.InheritGenomeInfo(GetOrg(birth_parent_id)); });
   // TODO: get rid of elite select version of this function for MAPE
 }
 
@@ -809,31 +1195,58 @@ void MapElitesSignalGPWorld::Init_Hardware() {
     state.SetLocal(inst.args[1], state.GetInput( (int)state.GetLocal(inst.args[0]) ) );
   }, 2, "WM[Arg2] = IN[WM[Arg1]]");
 
-  // Configure the evaluation hardware.
-  eval_hw = emp::NewPtr<hardware_t>(&inst_lib, &event_lib, random_ptr);
-  eval_hw->SetMinBindThresh(HW_MIN_TAG_SIMILARITY_THRESH);
-  eval_hw->SetMaxCores(HW_MAX_THREAD_CNT);
-  eval_hw->SetMaxCallDepth(HW_MAX_CALL_DEPTH);
-
-  // Collect function call information. 
-  eval_hw->OnBeforeFuncCall([this](hardware_t & hw, size_t fID) {
-    const size_t org_id =(size_t)hw.GetTrait(trait_id_t::ORG_ID);
-    phenotype_t & phen = phen_cache.Get(org_id, trial_id);
-    phen.functions_used_set.emplace(fID);
-    phen.function_entries.emplace_back(fID);
-  });
+}
 
-  eval_hw->OnBeforeCoreSpawn([this](hardware_t & hw, size_t fID) {
-    const size_t org_id = (size_t)hw.GetTrait(trait_id_t::ORG_ID);
-    phenotype_t & phen = phen_cache.Get(org_id, trial_id);
-    phen.functions_used_set.emplace(fID);
-    phen.function_entries.emplace_back(fID);
-  });
+/// Initialize evaluation contexts (one per evaluation worker), each with its own evaluation hardware.
+void MapElitesSignalGPWorld::Init_EvalContexts() {
+  std::cout << "Configuring evaluation workers (" << EVAL_THREADS << ")" << std::endl;
+  eval_pool.Resize(EVAL_THREADS);
+  EVAL_THREADS = eval_pool.GetSize();
+  // Evaluation never draws from the world's random number generator: every worker gets its own, which 
+  // is reseeded from eval_seed at the start of every evaluation trial (see EvaluateInto).
+  eval_seed = (uint64_t)random_ptr->GetSeed();
+  offspring_eval_cnt = 0;
+  for (size_t i = 0; i < EVAL_THREADS; ++i) {
+    emp::Ptr<eval_ctx_t> ctx = emp::NewPtr<eval_ctx_t>(i);
+    ctx->rnd = emp::NewPtr<emp::Random>(DeriveStreamSeed(eval_seed, {(uint64_t)i}));
+
+    // Configure the evaluation hardware.
+    ctx->hw = emp::NewPtr<hardware_t>(&inst_lib, &event_lib, ctx->rnd);
+    ctx->hw->SetMinBindThresh(HW_MIN_TAG_SIMILARITY_THRESH);
+    ctx->hw->SetMaxCores(HW_MAX_THREAD_CNT);
+    ctx->hw->SetMaxCallDepth(HW_MAX_CALL_DEPTH);
+
+    // Collect function call information (tallied by the worker; flushed to the phenotype cache once per trial). 
+    ctx->func_entries.Resize(PROG_MAX_FUNC_CNT);
+    ctx->hw->OnBeforeFuncCall([this](hardware_t & hw, size_t fID) {
+      GetEvalCtx(hw).func_entries.Record(fID);
+    });
+
+    ctx->hw->OnBeforeCoreSpawn([this](hardware_t & hw, size_t fID) {
+      GetEvalCtx(hw).func_entries.Record(fID);
+    });
 
+    eval_ctxs.emplace_back(ctx);
+  }
 }
 
 /// Initialize selected problem. 
+/// Initialize genome cache. Caching is only turned on if evaluation is deterministic given a genome. 
+void MapElitesSignalGPWorld::Init_GenomeCache() {
+  const bool deterministic = PROBLEM_TYPE == (size_t)PROBLEM_TYPE::TESTCASES && !SHUFFLE_TEST_CASES 
+                             && TESTCASE_SAMPLING == (size_t)TESTCASE_SAMPLING::FIXED;
+  if (GENOME_CACHE_SIZE && !deterministic) {
+    std::cout << "Evaluation is not deterministic for this problem configuration; ignoring GENOME_CACHE_SIZE." << std::endl;
+    genome_cache.SetCapacity(0);
+  } else {
+    genome_cache.SetCapacity(GENOME_CACHE_SIZE);
+  }
+  genome_cache.Clear();
+  genome_cache.ResetStats();
+}
+
 void MapElitesSignalGPWorld::Init_Problem() {
+  phen_layout = PhenotypeCache::Layout(PROG_MAX_FUNC_CNT);
   switch (PROBLEM_TYPE) {
     case (size_t)PROBLEM_TYPE::CHG_ENV: {
       SetupProblem_ChgEnv();
@@ -852,6 +1265,11 @@ void MapElitesSignalGPWorld::Init_Problem() {
       exit(-1);
     }
   }
+  // Give each evaluation context its own copy of the problem state.
+  for (size_t i = 0; i < eval_ctxs.size(); ++i) {
+    eval_ctxs[i]->chgenv_info = chgenv_info;
+    eval_ctxs[i]->task_set = task_set;
+  }
 }
 
 void MapElitesSignalGPWorld::Init_WorldMode() {
@@ -913,9 +1331,9 @@ void MapElitesSignalGPWorld::SetupProblem_ChgEnv() {
   // - Setup environment state changing
   switch (ENV_CHG_METHOD) {
     case (size_t)ENV_CHG_METHOD::SHUFFLE: {
-      do_env_advance_sig.AddAction([this]() {
-        ChgEnvProblemInfo & env = chgenv_info;
-        if (env.env_state == (size_t)-1 || random_ptr->P(ENV_CHG_PROB)) {
+      do_env_advance_sig.AddAction([this](eval_ctx_t & ctx) {
+        ChgEnvProblemInfo & env = ctx.chgenv_info;
+        if (env.env_state == (size_t)-1 || ctx.rnd->P(ENV_CHG_PROB)) {
           // Trigger change!
           // What state should we switch to?
           env.env_state = env.env_shuffler[env.env_shuffle_id]; 
@@ -923,18 +1341,18 @@ void MapElitesSignalGPWorld::SetupProblem_ChgEnv() {
           // If shuffle id exceeds env states, reset to 0 and shuffle!
           if (env.env_shuffle_id >= ENV_STATE_CNT) {
             env.env_shuffle_id = 0;
-            emp::Shuffle(*random_ptr, env.env_shuffler);
+            emp::Shuffle(*ctx.rnd, env.env_shuffler);
           }
           // 2) Trigger environment state event.
-          eval_hw->TriggerEvent("EnvSignal", env.env_state_tags[env.env_state]);
+          ctx.hw->TriggerEvent("EnvSignal", env.env_state_tags[env.env_state]);
         }
       });
       break;
     }
     case (size_t)ENV_CHG_METHOD::CYCLE: {
-      do_env_advance_sig.AddAction([this]() {
-        ChgEnvProblemInfo & env = chgenv_info;
-        if (env.env_state == (size_t)-1 || ((eval_time % ENV_CHG_RATE) == 0)) {
+      do_env_advance_sig.AddAction([this](eval_ctx_t & ctx) {
+        ChgEnvProblemInfo & env = ctx.chgenv_info;
+        if (env.env_state == (size_t)-1 || ((ctx.eval_time % ENV_CHG_RATE) == 0)) {
           // Trigger change!
           // What state should we switch to?
           env.env_state = env.env_shuffler[env.env_shuffle_id]; 
@@ -942,23 +1360,23 @@ void MapElitesSignalGPWorld::SetupProblem_ChgEnv() {
           // If shuffle id exceeds env states, reset to 0 and shuffle!
           if (env.env_shuffle_id >= ENV_STATE_CNT) {
             env.env_shuffle_id = 0;
-            emp::Shuffle(*random_ptr, env.env_shuffler);
+            emp::Shuffle(*ctx.rnd, env.env_shuffler);
           }
           // 2) Trigger environment state event.
-          eval_hw->TriggerEvent("EnvSignal", env.env_state_tags[env.env_state]);
+          ctx.hw->TriggerEvent("EnvSignal", env.env_state_tags[env.env_state]);
         }
       });
       break;
     }
     case (size_t)ENV_CHG_METHOD::RAND: {
-      do_env_advance_sig.AddAction([this]() {
-        ChgEnvProblemInfo & env = chgenv_info;
-        if (env.env_state == (size_t)-1 || random_ptr->P(ENV_CHG_PROB)) {
+      do_env_advance_sig.AddAction([this](eval_ctx_t & ctx) {
+        ChgEnvProblemInfo & env = ctx.chgenv_info;
+        if (env.env_state == (size_t)-1 || ctx.rnd->P(ENV_CHG_PROB)) {
           // Trigger change!
           // What state should we switch to?
-          env.env_state = random_ptr->GetUInt(ENV_STATE_CNT);
+          env.env_state = ctx.rnd->GetUInt(ENV_STATE_CNT);
           // 2) Trigger environment state event.
-          eval_hw->TriggerEvent("EnvSignal", env.env_state_tags[env.env_state]);
+          ctx.hw->TriggerEvent("EnvSignal", env.env_state_tags[env.env_state]);
         }
       });
       break;
@@ -971,10 +1389,10 @@ void MapElitesSignalGPWorld::SetupProblem_ChgEnv() {
 
   // - Setup distraction signals
   if (ENV_DISTRACTION_SIGS) {
-    do_env_advance_sig.AddAction([this]() {
-      if (random_ptr->P(ENV_DISTRACTION_SIG_CNT)) {
-        const size_t id = random_ptr->GetUInt(chgenv_info.distraction_sig_tags.size());
-        eval_hw->TriggerEvent("EnvSignal", chgenv_info.distraction_sig_tags[id]);
+    do_env_advance_sig.AddAction([this](eval_ctx_t & ctx) {
+      if (ctx.rnd->P(ENV_DISTRACTION_SIG_CNT)) {
+        const size_t id = ctx.rnd->GetUInt(ctx.chgenv_info.distraction_sig_tags.size());
+        ctx.hw->TriggerEvent("EnvSignal", ctx.chgenv_info.distraction_sig_tags[id]);
       }
     });
   }
@@ -983,24 +1401,21 @@ void MapElitesSignalGPWorld::SetupProblem_ChgEnv() {
     return phen.env_match_score;
   };
 
-  do_pop_init_sig.AddAction([this]() {
-    for (size_t i = 0; i < phen_cache.GetCache().size(); ++i) {
-      phen_cache.GetCache()[i].SetEnvCnt(ENV_STATE_CNT); 
-    }
-  });
+  phen_layout.env_cnt = ENV_STATE_CNT;
 
   // Reset the environment at the begining of a trial
-  begin_org_trial_sig.AddAction([this](org_t & org) {
-    chgenv_info.ResetEnv(*random_ptr);
+  begin_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    ctx.chgenv_info.ResetEnv(*ctx.rnd);
   });
 
-  do_org_advance_sig.AddAction([this](org_t & org) {
-    const size_t org_id = org.GetPos();
-    if ((size_t)eval_hw->GetTrait(org_t::ORG_STATE) == chgenv_info.env_state) {
-      phen_cache.Get(org_id, trial_id).env_match_score += 1;
-      phen_cache.Get(org_id, trial_id).matches_by_env[chgenv_info.env_state] += 1;
+  do_org_advance_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    const size_t env_state = ctx.chgenv_info.env_state;
+    phenotype_t phen = ctx.phens->Get(ctx.phen_id, ctx.trial_id);
+    if ((size_t)ctx.hw->GetTrait(org_t::ORG_STATE) == env_state) {
+      phen.env_match_score += 1;
+      phen.matches_by_env[env_state] += 1;
     }
-    phen_cache.Get(org_id, trial_id).time_by_env[chgenv_info.env_state] += 1;
+    phen.time_by_env[env_state] += 1;
   });
 
   // Setup instructions/events specific to changing environment problem.
@@ -1031,7 +1446,7 @@ void MapElitesSignalGPWorld::SetupProblem_ChgEnv() {
       inst_lib.AddInst("SenseState-" + emp::to_string(i),
         [this, i](hardware_t & hw, const inst_t & inst) {
           state_t & state = hw.GetCurState();
-          state.SetLocal(inst.args[0], this->chgenv_info.env_state==i);
+          state.SetLocal(inst.args[0], this->GetEvalCtx(hw).chgenv_info.env_state==i);
         }, 1, "Sense if current environment state is " + emp::to_string(i));
     }
   }
@@ -1056,64 +1471,132 @@ void MapElitesSignalGPWorld::SetupProblem_ChgEnv() {
 
 void MapElitesSignalGPWorld::SetupProblem_Testcases() {
   // TODO: fix warnings!
-  testcases.LoadTestcases(TESTCASES_FPATH);
-  std::cout << "Loaded test cases (" << testcases.GetTestcases().size() << ") from: " << TESTCASES_FPATH << std::endl;
-  emp_assert(NUM_TEST_CASES <= testcases.GetTestcases().size());
+  testcases.LoadTestcases(TESTCASES_FPATH, true, TESTCASES_CACHE);
+  std::cout << "Loaded test cases (" << testcases.GetSize() << ") from: " << TESTCASES_FPATH << std::endl;
+  if (NUM_TEST_CASES > testcases.GetSize()) {
+    std::cout << "NUM_TEST_CASES (" << NUM_TEST_CASES << ") is more than the number of test cases loaded (";
+    std::cout << testcases.GetSize() << "). Exiting..." << std::endl;
+    exit(-1);
+  }
 
-  for (size_t i = 0; i < testcases.GetTestcases().size(); ++i) testcase_ids.emplace_back(i);
+  for (size_t i = 0; i < testcases.GetSize(); ++i) testcase_ids.emplace_back(i);
+  phen_layout.testcase_cnt = NUM_TEST_CASES;
+
+  // Build every testcase's input memory (etc.) up front; evaluation reuses them for every organism. 
+  testcase_eval_info.resize(testcases.GetSize());
+  for (size_t testcase = 0; testcase < testcase_eval_info.size(); ++testcase) {
+    TestcaseEvalInfo & info = testcase_eval_info[testcase];
+    const auto inputs = testcases.GetInput(testcase);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      info.input_mem[(int)i] = inputs[i];
+    }
+    info.output = testcases.GetOutput(testcase);
+    const int divisor = (int)testcases.GetOutput(testcase);
+    info.divisor = (divisor == 0) ? 1 : divisor;
+  }
 
   // Setup fitness stuff
   // do_begin_eval
   begin_org_trial_sig.Clear();
   do_org_trial_sig.Clear();
 
-  begin_org_trial_sig.AddAction([this](org_t & org) {
+  begin_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
     // Reset phenotype
-    phen_cache.Get(org.GetPos(), trial_id).Reset();
+    ctx.phens->Get(ctx.phen_id, ctx.trial_id).Reset();
   });
   
-  if (SHUFFLE_TEST_CASES) {
-    begin_pop_evaluation_sig.AddAction([this]() {
+  // Pick this generation's test cases (always the first NUM_TEST_CASES of testcase_ids). 
+  // Phenotypes (and lexicase fitness functions) index test cases by position in the active subset, so they
+  // always line up with whatever subset is active.
+  switch (TESTCASE_SAMPLING) {
+    case (size_t)TESTCASE_SAMPLING::FIXED: {
+      if (SHUFFLE_TEST_CASES) {
+        begin_pop_evaluation_sig.AddAction([this]() {
+          emp::Shuffle(*random_ptr, testcase_ids);
+        });
+      }
+      break;
+    }
+    case (size_t)TESTCASE_SAMPLING::DOWN_SAMPLE: {
+      // Partial shuffle: only the active slots get drawn (cost scales with NUM_TEST_CASES, not data set size).
+      begin_pop_evaluation_sig.AddAction([this]() {
+        for (size_t i = 0; i < NUM_TEST_CASES; ++i) {
+          std::swap(testcase_ids[i], testcase_ids[random_ptr->GetUInt(i, testcase_ids.size())]);
+        }
+      });
+      break;
+    }
+    case (size_t)TESTCASE_SAMPLING::ROTATE: {
+      // Every test case gets used once every ceil(test case count / NUM_TEST_CASES) generations.
       emp::Shuffle(*random_ptr, testcase_ids);
-    });
+      begin_pop_evaluation_sig.AddAction([this]() {
+        if (GetUpdate() == 0) return;
+        std::rotate(testcase_ids.begin(), testcase_ids.begin() + NUM_TEST_CASES, testcase_ids.end());
+      });
+      break;
+    }
+    case (size_t)TESTCASE_SAMPLING::STRATIFIED: {
+      // Split test cases (sorted by output) into NUM_TEST_CASES nearly equal strata; draw one from each.
+      emp::vector<size_t> sorted_ids(testcase_ids);
+      std::stable_sort(sorted_ids.begin(), sorted_ids.end(), [this](size_t a, size_t b) {
+        return testcases.GetOutput(a) < testcases.GetOutput(b);
+      });
+      testcase_strata.resize(NUM_TEST_CASES);
+      for (size_t s = 0; s < NUM_TEST_CASES; ++s) {
+        const size_t begin = (s * sorted_ids.size()) / NUM_TEST_CASES;
+        const size_t end = ((s + 1) * sorted_ids.size()) / NUM_TEST_CASES;
+        testcase_strata[s].assign(sorted_ids.begin() + begin, sorted_ids.begin() + end);
+      }
+      testcase_ids.resize(NUM_TEST_CASES);
+      for (size_t s = 0; s < NUM_TEST_CASES; ++s) testcase_ids[s] = testcase_strata[s][0];
+      begin_pop_evaluation_sig.AddAction([this]() {
+        for (size_t s = 0; s < NUM_TEST_CASES; ++s) {
+          testcase_ids[s] = testcase_strata[s][random_ptr->GetUInt(testcase_strata[s].size())];
+        }
+      });
+      break;
+    }
+    default: {
+      std::cout << "Unrecognized test case sampling method (" << TESTCASE_SAMPLING << "). Exiting..." << std::endl;
+      exit(-1);
+    }
   }
   
-  do_org_trial_sig.AddAction([this](org_t & org) {
+  // Run all of a trial's testcases as a batch: full hardware reset once per trial, lighter reset per testcase. 
+  do_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    static const tag_t main_tag;
+    ResetEvalHW(ctx);
+    ctx.hw->SetTrait(trait_id_t::ORG_ID, ctx.phen_id);
+    phenotype_t phen = ctx.phens->Get(ctx.phen_id, ctx.trial_id);
     for (size_t t = 0; t < NUM_TEST_CASES; ++t) {
       size_t testcase = testcase_ids[t];
-      testcase_info.cur_testcase = testcase;
-
-      ResetEvalHW();
-      eval_hw->SetTrait(trait_id_t::ORG_ID, org.GetPos());
-      // Fill out input memory with testcase info. 
-      memory_t input_mem;
-      for (size_t i = 0; i < testcases.GetInput(testcase).size(); ++i) {
-        input_mem[(int)i] = testcases.GetInput(testcase)[i];
-      }
-      // Spawn main core!
-      eval_hw->SpawnCore(tag_t(), 0.0, input_mem, true);
+      const TestcaseEvalInfo & info = testcase_eval_info[testcase];
+      ctx.testcase_info.cur_testcase = testcase;
+
+      ResetEvalHWForTestcase(ctx);
+      // Spawn main core (with testcase inputs)!
+      ctx.hw->SpawnCore(main_tag, 0.0, info.input_mem, true);
 
       // std::cout << "====INITIAL STATE====" << std::endl;
-      // eval_hw->PrintState();
+      // ctx.hw->PrintState();
 
-      // Process!
-      for (eval_time = 0; eval_time < EVAL_TIME; ++eval_time) {
+      // Process! (stopping early if outcome is settled and we're allowed to)
+      for (ctx.eval_time = 0; ctx.eval_time < EVAL_TIME; ++ctx.eval_time) {
+        if (EVAL_EARLY_EXIT && IsTestcaseSettled(ctx)) break;
         // Advance agent.
-        do_org_advance_sig.Trigger(org);
+        do_org_advance_sig.Trigger(org, ctx);
 
-        // std::cout << "====" << eval_time << "====" << std::endl;
-        // eval_hw->PrintState();
+        // std::cout << "====" << ctx.eval_time << "====" << std::endl;
+        // ctx.hw->PrintState();
       }
 
       // Check output
-      double output = eval_hw->GetTrait(trait_id_t::PROBLEM_OUTPUT);
-      bool output_set = (bool)eval_hw->GetTrait(trait_id_t::OUTPUT_SET);
+      double output = ctx.hw->GetTrait(trait_id_t::PROBLEM_OUTPUT);
+      bool output_set = (bool)ctx.hw->GetTrait(trait_id_t::OUTPUT_SET);
 
       double result = 0;
       if (output_set) {
-        int divisor = (int)testcases.GetOutput(testcase);
-        if (divisor == 0) divisor = 1;
-        result = std::abs(1 / (std::abs(output - testcases.GetOutput(testcase))/divisor));
+        result = std::abs(1 / (std::abs(output - info.output)/info.divisor));
       }
       if (result > 1000) result = 1000;
       
@@ -1126,44 +1609,45 @@ void MapElitesSignalGPWorld::SetupProblem_Testcases() {
       // std::cout << "Org Output = " << output << std::endl;
       // std::cout << "Result = " << result << std::endl;
 
-
-      phenotype_t & phen = phen_cache.Get(org.GetPos(), trial_id);
-      phen.testcase_results.emplace_back(result);
+      phen.AddTestcaseResult(result, ctx.eval_time);
+      ctx.testcase_info.steps_run += ctx.eval_time;
+      ctx.testcase_info.cases_run += 1;
     }
   });
 
   calc_score = [](org_t & org, phenotype_t & phen) {
-    return emp::Sum(phen.testcase_results);
+    return phen.GetTestcaseResultTotal();
   };
   
   // Setup extra instructions
   // - Submit
   inst_lib.AddInst("SubmitResult", 
-    [](hardware_t & hw, const inst_t & inst) {
+    [this](hardware_t & hw, const inst_t & inst) {
+      if (FIRST_SUBMIT_WINS && (bool)hw.GetTrait(trait_id_t::OUTPUT_SET)) return;
       state_t & state = hw.GetCurState();
       hw.SetTrait(trait_id_t::PROBLEM_OUTPUT, state.GetLocal(inst.args[0]));
       hw.SetTrait(trait_id_t::OUTPUT_SET, 1);
-    }, 1, "Submit output for given input.");
+    }, 1, "Submit output for given input (if FIRST_SUBMIT_WINS, only the first submission counts).");
   // - Load testcase problem input to input memory
   inst_lib.AddInst("LoadToInput", [this](hardware_t & hw, const inst_t & inst) {
     state_t & state = hw.GetCurState();
-    const size_t cur_test = testcase_info.cur_testcase;
-    for (size_t i = 0; i < testcases.GetInput(cur_test).size(); ++i) {
-      state.SetInput(inst.args[0] + (int)i, (double)testcases.GetInput(cur_test)[i]);   
+    const auto inputs = testcases.GetInput(GetEvalCtx(hw).testcase_info.cur_testcase);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      state.SetInput(inst.args[0] + (int)i, (double)inputs[i]);   
     }
   }, 1, "INPUT[ARG1:TESTCASE_INPUTS] = TESTCASE_INPUTS");
   // - load testcase problem input to working memory
   inst_lib.AddInst("LoadToWorking", [this](hardware_t & hw, const inst_t & inst) {
     state_t & state = hw.GetCurState();
-    const size_t cur_test = testcase_info.cur_testcase;
-    for (size_t i = 0; i < testcases.GetInput(cur_test).size(); ++i) {
-      state.SetLocal(inst.args[0] + (int)i, (double)testcases.GetInput(cur_test)[i]);   
+    const auto inputs = testcases.GetInput(GetEvalCtx(hw).testcase_info.cur_testcase);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      state.SetLocal(inst.args[0] + (int)i, (double)inputs[i]);   
     }
   }, 1, "WM[ARG1:TESTCASE_INPUTS] = TESTCASE_INPUTS");
   // - get the number of inputs for this testcase problem inputs
   inst_lib.AddInst("InputCnt", [this](hardware_t & hw, const inst_t & inst) {
     state_t & state = hw.GetCurState();
-    const size_t cur_test = testcase_info.cur_testcase;
+    const size_t cur_test = GetEvalCtx(hw).testcase_info.cur_testcase;
     state.SetLocal(inst.args[0], testcases.GetInput(cur_test).size());
   }, 1, "WM[ARG1] = InputCnt");
 
@@ -1186,8 +1670,10 @@ void MapElitesSignalGPWorld::SetupProblem_Logic() {
 
   // Configure the tasks. 
   // Zero out task inputs.
-  for (size_t i = 0; i < MAX_LOGIC_TASK_NUM_INPUTS; ++i) task_inputs[i] = 0;
-  input_load_id = 0;
+  for (size_t i = 0; i < eval_ctxs.size(); ++i) {
+    for (size_t k = 0; k < MAX_LOGIC_TASK_NUM_INPUTS; ++k) eval_ctxs[i]->task_inputs[k] = 0;
+    eval_ctxs[i]->input_load_id = 0;
+  }
 
   // Add tasks to set.
   // NAND
@@ -1245,30 +1731,38 @@ void MapElitesSignalGPWorld::SetupProblem_Logic() {
     task.solutions.emplace_back(b);
   }, "ECHO task");
 
-  // Need this to happen before run, but after phenotype cache resize.
-  do_pop_init_sig.AddAction([this]() {
-    for (size_t i = 0; i < phen_cache.GetCache().size(); ++i) {
-      phen_cache.GetCache()[i].SetTaskCnt(task_set.GetSize());
-    }
-  }); // 
+  phen_layout.task_cnt = task_set.GetSize();
+
+  // Generate collision-free inputs up front (if we're sampling from a pool). 
+  if (LOGIC_INPUT_POOL_SIZE) {
+    task_set.FillInputPool(logic_input_pool, LOGIC_INPUT_POOL_SIZE, [this]() {
+      std::array<task_io_t, MAX_LOGIC_TASK_NUM_INPUTS> inputs;
+      inputs[0] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+      inputs[1] = random_ptr->GetUInt(MIN_LOGIC_TASK_INPUT, MAX_LOGIC_TASK_INPUT);
+      return inputs;
+    });
+  }
 
   // Add logic problem instructions
   inst_lib.AddInst("Load-1", [this](hardware_t & hw, const inst_t & inst) {
     state_t & state = hw.GetCurState();
-    state.SetLocal(inst.args[0], task_inputs[input_load_id]); // Load input.
-    input_load_id += 1;
-    if (input_load_id >= task_inputs.size()) input_load_id = 0; // Update load ID.
+    eval_ctx_t & ctx = GetEvalCtx(hw);
+    state.SetLocal(inst.args[0], ctx.task_inputs[ctx.input_load_id]); // Load input.
+    ctx.input_load_id += 1;
+    if (ctx.input_load_id >= ctx.task_inputs.size()) ctx.input_load_id = 0; // Update load ID.
   }, 1, "WM[ARG1] = TaskInput[LOAD_ID]; LOAD_ID++;");
 
   inst_lib.AddInst("Load-2", [this](hardware_t & hw, const inst_t & inst) { 
     state_t & state = hw.GetCurState();
-    state.SetLocal(inst.args[0], task_inputs[0]);
-    state.SetLocal(inst.args[1], task_inputs[1]);
+    eval_ctx_t & ctx = GetEvalCtx(hw);
+    state.SetLocal(inst.args[0], ctx.task_inputs[0]);
+    state.SetLocal(inst.args[1], ctx.task_inputs[1]);
   }, 2, "WM[ARG1] = TASKINPUT[0]; WM[ARG2] = TASKINPUT[1];");
  
   inst_lib.AddInst("Submit", [this](hardware_t & hw, const inst_t & inst) { 
     state_t & state = hw.GetCurState();
-    task_set.Submit((task_io_t)state.GetLocal(inst.args[0]), eval_time);
+    eval_ctx_t & ctx = GetEvalCtx(hw);
+    ctx.task_set.Submit((task_io_t)state.GetLocal(inst.args[0]), ctx.eval_time);
   }, 1, "Submit WM[ARG1] as potential task solution.");
 
   inst_lib.AddInst("Nand", [](hardware_t & hw, const inst_t & inst) {
@@ -1288,23 +1782,36 @@ void MapElitesSignalGPWorld::SetupProblem_Logic() {
   };
 
   // Reset tasks at beginning of a trial. 
-  begin_org_trial_sig.AddAction([this](org_t & org) {
-    ResetTasks();
+  begin_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    ResetTasks(ctx);
     memory_t input_mem;
-    for (size_t i = 0; i < MAX_LOGIC_TASK_NUM_INPUTS; ++i) input_mem[(int)i] = task_inputs[i];
-    eval_hw->SpawnCore(tag_t(), 0.0, input_mem, true);
+    for (size_t i = 0; i < MAX_LOGIC_TASK_NUM_INPUTS; ++i) input_mem[(int)i] = ctx.task_inputs[i];
+    ctx.hw->SpawnCore(tag_t(), 0.0, input_mem, true);
+  });
+
+  // Once every task is credited, score can no longer change (calc_score only depends on when all tasks were 
+  // credited and how many were). Remaining steps only affect execution traits (e.g., function entries), 
+  // so we only skip them when EVAL_EARLY_EXIT is on.
+  do_org_trial_sig.Clear();
+  do_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    for (ctx.eval_time = 0; ctx.eval_time < EVAL_TIME; ++ctx.eval_time) {
+      if (EVAL_EARLY_EXIT && ctx.task_set.AllTasksCredited()) break;
+      do_env_advance_sig.Trigger(ctx);
+      do_org_advance_sig.Trigger(org, ctx);
+    }
+    ctx.logic_info.steps_saved += EVAL_TIME - ctx.eval_time;
+    ctx.logic_info.trials_run += 1;
   });
 
   // Logic problem needs non-default end_org_trial action.
   end_org_trial_sig.Clear();
-  end_org_trial_sig.AddAction([this](org_t & org) {
-    const size_t id = org.GetPos();
-    phenotype_t & phen = phen_cache.Get(id, trial_id); 
+  end_org_trial_sig.AddAction([this](org_t & org, eval_ctx_t & ctx) {
+    phenotype_t phen = ctx.phens->Get(ctx.phen_id, ctx.trial_id); 
     // Update logic problem phenotype info
-    phen.time_all_logic_tasks_done = task_set.GetAllTasksCreditedTime();
-    phen.unique_logic_tasks_done = task_set.GetUniqueTasksCredited();
-    for (size_t taskID = 0; taskID < task_set.GetSize(); ++taskID) {
-      phen.logic_tasks_done_by_task[taskID] = task_set.GetTask(taskID).GetCreditedCnt();
+    phen.time_all_logic_tasks_done = ctx.task_set.GetAllTasksCreditedTime();
+    phen.unique_logic_tasks_done = ctx.task_set.GetUniqueTasksCredited();
+    for (size_t taskID = 0; taskID < ctx.task_set.GetSize(); ++taskID) {
+      phen.logic_tasks_done_by_task[taskID] = ctx.task_set.GetTask(taskID).GetCreditedCnt();
     }
     phen.score = calc_score(org, phen);
   });
@@ -1343,7 +1850,7 @@ void MapElitesSignalGPWorld::SetupProblem_Logic() {
       [this]() { 
         double total = 0;
         for (size_t i = 0; i < EVAL_TRIAL_CNT; ++i) {
-          total += phen_cache.Get(pop_snapshot_info.cur_org_id, i).time_all_logic_tasks_done;
+          total += phen_cache.Get(pop_snapshot_info.cur_phen_id, i).time_all_logic_tasks_done;
         }
         return total / EVAL_TRIAL_CNT;
       }, "");
@@ -1352,7 +1859,7 @@ void MapElitesSignalGPWorld::SetupProblem_Logic() {
       [this]() { 
         double total = 0;
         for (size_t i = 0; i < EVAL_TRIAL_CNT; ++i) {
-          total += phen_cache.Get(pop_snapshot_info.cur_org_id, i).unique_logic_tasks_done;
+          total += phen_cache.Get(pop_snapshot_info.cur_phen_id, i).unique_logic_tasks_done;
         }
         return total / EVAL_TRIAL_CNT;
       }, "");
@@ -1382,7 +1889,7 @@ void MapElitesSignalGPWorld::SetupProblem_Logic() {
         [this, taskID]() { 
           double total = 0;
           for (size_t i = 0; i < EVAL_TRIAL_CNT; ++i) {
-            total += phen_cache.Get(pop_snapshot_info.cur_org_id, i).logic_tasks_done_by_task[taskID];
+            total += phen_cache.Get(pop_snapshot_info.cur_phen_id, i).logic_tasks_done_by_task[taskID];
           }
           return total / EVAL_TRIAL_CNT; 
         }, "");
@@ -1405,6 +1912,212 @@ void MapElitesSignalGPWorld::SetupProblem_Logic() {
 
 }
 
+void MapElitesSignalGPWorld::EvaluatePopulation() {
+  // 1) Serially, collect everyone that needs evaluating, skipping organisms whose genomes are cached. With genome
+  //    caching, evaluation only depends on the genome, so each genome gets queued (at most) once per pass.
+  eval_queue.clear();
+  eval_hashes.clear();
+  eval_firsts.clear();
+  eval_dups.clear();
+  for (size_t id = 0; id < GetSize(); ++id) {
+    org_t & org = GetOrg(id);
+    org.SetPos(id);
+    size_t hash = 0;
+    if (genome_cache.IsActive()) {
+      hash = org.GetGenome().Hash();
+      auto first = eval_firsts.find(hash);
+      if (first != eval_firsts.end() && GetGenomeAt(first->second) == org.GetGenome()) {
+        eval_dups.emplace_back(id, first->second);
+        genome_cache.CountHit();
+        continue;
+      }
+      const PhenotypeCache * cached = genome_cache.Find(org.GetGenome(), hash);
+      if (cached) { LoadPhenotypes(id, *cached); continue; }
+      eval_firsts.emplace(hash, id);
+    }
+    eval_queue.emplace_back(id);
+    eval_hashes.emplace_back(hash);
+  }
+  // 2) Evaluate (in parallel if we have multiple evaluation workers).
+  eval_pool.Run(eval_queue.size(), [this](size_t worker_id, size_t job_id) {
+    Evaluate(GetOrg(eval_queue[job_id]), *eval_ctxs[worker_id]);
+  });
+  // 3) Serially, hand evaluations to duplicate genomes, and remember new evaluations.
+  for (const std::pair<size_t, size_t> & dup : eval_dups) phen_cache.CopyOrg(dup.first, phen_cache, dup.second);
+  if (genome_cache.IsActive()) {
+    for (size_t i = 0; i < eval_queue.size(); ++i) {
+      genome_cache.Insert(GetOrg(eval_queue[i]).GetGenome(), eval_hashes[i], SavePhenotypes(eval_queue[i]));
+    }
+  }
+  for (size_t id = 0; id < GetSize(); ++id) phen_valid[id] = true;
+}
+
+void MapElitesSignalGPWorld::DoMapeBatch(size_t batch_size) {
+  const size_t batch_row = GetSize() + 1;
+  mape_batch.Resize(batch_size);
+  if (fit_cache.size() < GetSize()) fit_cache.resize(GetSize(), 0.0);
+  // 1) Serially, breed offspring from the MAP as it stands (parents and mutations drawn from the world random
+  //    number generator, in birth order), and hand out evaluation streams (in birth order). With genome caching,
+  //    offspring whose genome is cached or already in the batch aren't evaluated.
+  const emp::vector<size_t> parent_ids = GetValidOrgIDs();
+  emp_assert(parent_ids.size());
+  eval_firsts.clear();
+  for (size_t i = 0; i < batch_size; ++i) {
+    const size_t parent_id = parent_ids[random_ptr->GetUInt(parent_ids.size())];
+    emp::Ptr<org_t> offspring = emp::NewPtr<org_t>(GetGenomeAt(parent_id));
+    offspring->InheritGenomeInfo(GetOrg(parent_id));
+    DoMutationsOrg(*offspring);
+    offspring->SetPos(batch_row + i);
+    mape_batch.orgs[i] = offspring;
+    mape_batch.parents[i] = parent_id;
+    mape_batch.streams[i] = MapeBatch::NO_EVAL;
+    mape_batch.sources[i] = MapeBatch::NO_SOURCE;
+    if (genome_cache.IsActive()) {
+      const size_t hash = offspring->GetGenome().Hash();
+      mape_batch.hashes[i] = hash;
+      auto first = eval_firsts.find(hash);
+      if (first != eval_firsts.end() && mape_batch.orgs[first->second]->GetGenome() == offspring->GetGenome()) {
+        mape_batch.sources[i] = first->second;
+        genome_cache.CountHit();
+        continue;
+      }
+      const PhenotypeCache * cached = genome_cache.Find(offspring->GetGenome(), hash);
+      if (cached) { LoadPhenotypes(batch_row + i, *cached); continue; }
+      eval_firsts.emplace(hash, i);
+    }
+    mape_batch.streams[i] = offspring_eval_cnt++;
+  }
+  // 2) Evaluate offspring and figure out which cell each belongs in (in parallel if we have multiple workers).
+  //    Offspring with a source get their source's results in step 3.
+  eval_pool.Run(batch_size, [this](size_t worker_id, size_t i) {
+    if (mape_batch.sources[i] != MapeBatch::NO_SOURCE) return;
+    org_t & org = *mape_batch.orgs[i];
+    if (mape_batch.streams[i] != MapeBatch::NO_EVAL) {
+      Evaluate(org, *eval_ctxs[worker_id], EVAL_STREAM::OFFSPRING, mape_batch.streams[i]);
+    }
+    mape_batch.fitness[i] = agg_scores(org);
+    mape_batch.cells[i] = GetPhenotypes().EvalBin(org, trait_bin_sizes);
+  });
+  // 3) Serially, hand evaluations to duplicate genomes, remember new evaluations, and group offspring competing for
+  //    the same cell.
+  for (size_t i = 0; i < batch_size; ++i) {
+    const size_t source = mape_batch.sources[i];
+    if (source != MapeBatch::NO_SOURCE) {
+      phen_cache.CopyOrg(batch_row + i, phen_cache, batch_row + source);
+      mape_batch.fitness[i] = mape_batch.fitness[source];
+      mape_batch.cells[i] = mape_batch.cells[source];
+    }
+    if (mape_batch.streams[i] != MapeBatch::NO_EVAL && genome_cache.IsActive()) {
+      genome_cache.Insert(mape_batch.orgs[i]->GetGenome(), mape_batch.hashes[i], SavePhenotypes(batch_row + i));
+    }
+    if (mape_batch.fitness[i] > best_score) best_score = mape_batch.fitness[i];
+    mape_batch.order[i] = i;
+  }
+  std::stable_sort(mape_batch.order.begin(), mape_batch.order.end(), 
+                   [this](size_t a, size_t b) { return mape_batch.cells[a] < mape_batch.cells[b]; });
+  // 4) Occupants of contested cells without a cached fitness get evaluated (just as CalcFitnessID would), in parallel.
+  eval_queue.clear();
+  eval_hashes.clear();
+  for (size_t k = 0; k < batch_size; ++k) {
+    const size_t cell = mape_batch.cells[mape_batch.order[k]];
+    if ((k && cell == mape_batch.cells[mape_batch.order[k-1]]) || !IsOccupied(cell) || GetCache(cell) != 0.0) continue;
+    org_t & occupant = GetOrg(cell);
+    size_t hash = 0;
+    if (genome_cache.IsActive()) {
+      hash = occupant.GetGenome().Hash();
+      const PhenotypeCache * cached = genome_cache.Find(occupant.GetGenome(), hash);
+      if (cached) {
+        LoadPhenotypes(cell, *cached);
+        phen_valid[cell] = true;
+        fit_cache[cell] = agg_scores(occupant);
+        continue;
+      }
+    }
+    eval_queue.emplace_back(cell);
+    eval_hashes.emplace_back(hash);
+  }
+  const size_t stream_base = offspring_eval_cnt;
+  offspring_eval_cnt += eval_queue.size();
+  eval_pool.Run(eval_queue.size(), [this, stream_base](size_t worker_id, size_t job_id) {
+    Evaluate(GetOrg(eval_queue[job_id]), *eval_ctxs[worker_id], EVAL_STREAM::OFFSPRING, stream_base + job_id);
+  });
+  for (size_t j = 0; j < eval_queue.size(); ++j) {
+    const size_t cell = eval_queue[j];
+    if (genome_cache.IsActive()) genome_cache.Insert(GetOrg(cell).GetGenome(), eval_hashes[j], SavePhenotypes(cell));
+    phen_valid[cell] = true;
+    fit_cache[cell] = agg_scores(GetOrg(cell));
+    if (fit_cache[cell] > best_score) best_score = fit_cache[cell];
+  }
+  // 5) Serially, commit each contested cell to its best offspring (the last-born one, if tied), unless the
+  //    occupant is strictly better; this is where SetMapElites would leave the cell if the same offspring were
+  //    placed one at a time, in birth order (empty cells count as fitness 0, as in CalcFitnessID).
+  for (size_t k = 0; k < batch_size; ) {
+    const size_t cell = mape_batch.cells[mape_batch.order[k]];
+    size_t winner = mape_batch.order[k];
+    for (++k; k < batch_size && mape_batch.cells[mape_batch.order[k]] == cell; ++k) {
+      if (mape_batch.fitness[mape_batch.order[k]] >= mape_batch.fitness[winner]) winner = mape_batch.order[k];
+    }
+    if (GetCache(cell) > mape_batch.fitness[winner]) continue;
+    AddOrgAt(mape_batch.orgs[winner], emp::WorldPosition(cell), emp::WorldPosition(mape_batch.parents[winner]));
+    fit_cache[cell] = mape_batch.fitness[winner];
+    mape_batch.orgs[winner] = nullptr;
+  }
+  for (emp::Ptr<org_t> & offspring : mape_batch.orgs) {
+    if (offspring) offspring.Delete();
+    offspring = nullptr;
+  }
+}
+
+void MapElitesSignalGPWorld::SnapshotEvaluations(emp::DataFile & file, const emp::vector<size_t> & org_ids, 
+                                                 size_t eval_cnt, size_t & evalID) {
+  const size_t temp_id = GetSize();
+  temp_phen_org = nullptr; // We're about to clobber the spare phen_cache position.
+  const size_t job_cnt = org_ids.size() * eval_cnt;
+  for (size_t chunk_start = 0; chunk_start < job_cnt; chunk_start += SNAPSHOT_EVAL_CHUNK) {
+    const size_t chunk_size = emp::Min(SNAPSHOT_EVAL_CHUNK, job_cnt - chunk_start);
+    // 1) Serially, figure out which evaluations we actually need to run. 
+    //    - The first evaluation of an organism can reuse the phenotypes already sitting in phen_cache.
+    snapshot_jobs.clear();
+    for (size_t job = chunk_start; job < chunk_start + chunk_size; ++job) {
+      const size_t orgID = org_ids[job / eval_cnt];
+      if (job % eval_cnt == 0 && SNAPSHOT_REUSE_PHENOTYPES && phen_valid[orgID]) continue;
+      snapshot_jobs.emplace_back(job);
+    }
+    if (snapshot_phen_cache.GetOrgCnt() < chunk_size) snapshot_phen_cache.Resize(chunk_size, EVAL_TRIAL_CNT, phen_layout);
+    // 2) Run them (in parallel if we have multiple evaluation workers). 
+    //    Each evaluation draws from the same random number stream as it would if run serially.
+    eval_pool.Run(snapshot_jobs.size(), [this, &org_ids, eval_cnt, chunk_start](size_t worker_id, size_t job_id) {
+      const size_t job = snapshot_jobs[job_id];
+      const size_t orgID = org_ids[job / eval_cnt];
+      EvaluateInto(GetOrg(orgID), *eval_ctxs[worker_id], snapshot_phen_cache, job - chunk_start, orgID, 
+                   EVAL_STREAM::SNAPSHOT, job % eval_cnt);
+    });
+    snapshot_info.evals_run += snapshot_jobs.size();
+    snapshot_info.evals_reused += chunk_size - snapshot_jobs.size();
+    // 3) Serially, output results (in order). 
+    size_t next_job = 0;
+    for (size_t job = chunk_start; job < chunk_start + chunk_size; ++job) {
+      const size_t orgID = org_ids[job / eval_cnt];
+      org_t & org = GetOrg(orgID);
+      evalID = job % eval_cnt;
+      pop_snapshot_info.cur_org_id = orgID;
+      if (next_job < snapshot_jobs.size() && snapshot_jobs[next_job] == job) {
+        ++next_job;
+        // Fresh evaluation; stage it in the spare phen_cache position so stats functions can find it.
+        phen_cache.CopyOrg(temp_id, snapshot_phen_cache, job - chunk_start);
+        if (evalID == 0) { phen_cache.CopyOrg(orgID, snapshot_phen_cache, job - chunk_start); phen_valid[orgID] = true; }
+        pop_snapshot_info.cur_phen_id = temp_id;
+      } else {
+        pop_snapshot_info.cur_phen_id = orgID;
+      }
+      const size_t pos = org.GetPos();
+      org.SetPos(pop_snapshot_info.cur_phen_id);
+      file.Update();
+      org.SetPos(pos);
+    }
+  }
+}
+
 void MapElitesSignalGPWorld::SetupWorldMode_WellMixed() {
   
   SetPopStruct_Mixed(true);
@@ -1414,11 +2127,10 @@ void MapElitesSignalGPWorld::SetupWorldMode_WellMixed() {
   // do_evaluation_sig
   do_evaluation_sig.AddAction([this]() {
     // Evaluate e'rybody! 
+    EvaluatePopulation();
+    // Fitness caching/dominant tracking touch shared world state, so do it serially. 
     for (size_t id = 0; id < GetSize(); ++id) {
-      org_t & org = GetOrg(id);
-      org.SetPos(id);
-      Evaluate(org);
-      double fitness = CalcFitnessOrg(org);
+      double fitness = CalcFitnessOrg(GetOrg(id));
       if (fitness > best_score || id == 0) { best_score = fitness; dominant_id = id; }
     }
   });
@@ -1434,7 +2146,9 @@ void MapElitesSignalGPWorld::SetupWorldMode_WellMixed() {
     }
     case (size_t)SELECTION_METHOD::LEXICASE: {
       do_selection_sig.AddAction([this]() {
-        emp::LexicaseSelect(*this, lexicase_fit_set, POP_SIZE);
+        FillLexicaseScores();
+        lexicase_selector.Select(lexicase_scores, eval_pool, random_ptr->GetUInt(), POP_SIZE, lexicase_winners);
+        for (size_t id : lexicase_winners) DoBirth(GetGenomeAt(id), id);
       });
       break;
     }
@@ -1454,10 +2168,17 @@ void MapElitesSignalGPWorld::SetupWorldMode_WellMixed() {
     return agg_scores(org);
   });
 
+  // Once the population turns over, cached phenotypes no longer describe who's at each position.
+  do_world_update_sig.AddAction([this]() { InvalidatePhenotypes(); });
+
   // Well-mixed-specific data tracking
   #ifndef EMSCRIPTEN
   // Setup dominant snapshotting.
-  do_pop_snapshot_sig.AddAction([this]() { Snapshot_Dominant(); }); 
+  do_pop_snapshot_sig.AddAction([this]() { 
+    auto start = std::chrono::steady_clock::now();
+    Snapshot_Dominant(); 
+    RecordSnapshotTiming("dominant", start);
+  }); 
 
   // Setup dominant file stats. 
   dom_file_stats.emplace_back("update", [this](){ return GetUpdate(); }, "Update (generation) in world.");
@@ -1489,7 +2210,9 @@ void MapElitesSignalGPWorld::SetupWorldMode_WellMixed() {
   // One of last things to do before run: resize phenotype cache
   do_begin_run_sig.AddAction([this]() {
     std::cout << "Resizing the phenotype cache(" << POP_SIZE << ")!" << std::endl;
-    phen_cache.Resize(POP_SIZE+1, EVAL_TRIAL_CNT); // Add one position as temp position for MAP-elites
+    phen_cache.Resize(POP_SIZE+1, EVAL_TRIAL_CNT, phen_layout); // Add one position as temp position for MAP-elites
+    phen_valid.resize(POP_SIZE+1);
+    InvalidatePhenotypes();
   });
   
 }
@@ -1502,21 +2225,41 @@ void MapElitesSignalGPWorld::SetupWorldMode_MAPE() {
   // do_evaluation_sig
   do_evaluation_sig.AddAction([this]() {
     best_score = MIN_POSSIBLE_SCORE;
+    offspring_eval_cnt = 0;
   });
 
   // do_selection_sig
+  // - Select sparsely until the MAP is at least half full. 
+  // - Or, breed/evaluate offspring in batches (see DoMapeBatch).
   do_selection_sig.AddAction([this]() {
-    emp::RandomSelectSparse(*this, POP_SIZE);
-    if (GetNumOrgs() >= (GetSize() * 0.5)) {
-      do_selection_sig.Clear();
-      do_selection_sig.AddAction([this]() {
-        emp::RandomSelect(*this, POP_SIZE);
-      });
+    if (MAPE_BATCH_SIZE) {
+      for (size_t born = 0; born < POP_SIZE; born += MAPE_BATCH_SIZE) DoMapeBatch(emp::Min(MAPE_BATCH_SIZE, POP_SIZE - born));
+    } else if (mape_dense_select) {
+      emp::RandomSelect(*this, POP_SIZE);
+    } else {
+      emp::RandomSelectSparse(*this, POP_SIZE);
+      mape_dense_select = GetNumOrgs() >= (GetSize() * 0.5);
     }
   });
   
+  // New organisms are evaluated into the spare phenotype cache position (GetSize()) until they're placed. 
+  OnOffspringReady([this](org_t & org) { org.SetPos(GetSize()); });
+  OnInjectReady([this](org_t & org) { org.SetPos(GetSize()); });
+
   OnBeforePlacement([this](org_t & org, size_t pos) {
-    org.SetPos(GetSize()); // Indicate that this organism has not been placed yet (useful for MAPE). 
+    // If the spare position still holds this organism's phenotypes, move them to where it's going.
+    if (&org == temp_phen_org) {
+      phen_cache.CopyOrg(pos, phen_cache, GetSize());
+      phen_valid[pos] = true;
+    } else if (org.GetPos() > GetSize()) {
+      // Batched offspring: phenotypes are waiting in the offspring's own batch row.
+      phen_cache.CopyOrg(pos, phen_cache, org.GetPos());
+      phen_valid[pos] = true;
+    } else {
+      phen_valid[pos] = false;
+    }
+    temp_phen_org = nullptr;
+    org.SetPos(pos);
   });
 
   // Setup fitness function
@@ -1524,8 +2267,21 @@ void MapElitesSignalGPWorld::SetupWorldMode_MAPE() {
     // const size_t id = GetSize();
     // org.SetPos(id);
     // TODO: confirm organism position!
-    // Evaluate!
-    Evaluate(org);
+    // Evaluate! (each offspring this update gets its own random number stream)
+    if (genome_cache.IsActive()) {
+      const size_t hash = org.GetGenome().Hash();
+      const PhenotypeCache * cached = genome_cache.Find(org.GetGenome(), hash);
+      if (cached) {
+        LoadPhenotypes(org.GetPos(), *cached);
+      } else {
+        Evaluate(org, EVAL_STREAM::OFFSPRING, offspring_eval_cnt++);
+        genome_cache.Insert(org.GetGenome(), hash, SavePhenotypes(org.GetPos()));
+      }
+    } else {
+      Evaluate(org, EVAL_STREAM::OFFSPRING, offspring_eval_cnt++);
+    }
+    if (org.GetPos() < GetSize()) phen_valid[org.GetPos()] = true;
+    else temp_phen_org = &org;
     // Grab score
     const double score = agg_scores(org);
     if (score > best_score) { best_score = score; }
@@ -1535,7 +2291,11 @@ void MapElitesSignalGPWorld::SetupWorldMode_MAPE() {
 
   // MAPE-specific data tracking
   #ifndef EMSCRIPTEN
-  do_pop_snapshot_sig.AddAction([this]() { Snapshot_MAP(); }); 
+  do_pop_snapshot_sig.AddAction([this]() { 
+    auto start = std::chrono::steady_clock::now();
+    Snapshot_MAP(); 
+    RecordSnapshotTiming("map", start);
+  }); 
   #endif
 
   // Setup traits
@@ -1545,8 +2305,12 @@ void MapElitesSignalGPWorld::SetupWorldMode_MAPE() {
   // One of last things to do before run: resize phenotype cache
   do_begin_run_sig.AddAction([this]() {
     emp::SetMapElites(*this, trait_bin_sizes);
-    std::cout << "Resizing the phenotype cache (" << GetSize() + 1 << ")!" << std::endl;
-    phen_cache.Resize(GetSize() + 1, EVAL_TRIAL_CNT); // Add one position as temp position for MAP-elites
+    std::cout << "Resizing the phenotype cache (" << GetSize() + 1 + MAPE_BATCH_SIZE << ")!" << std::endl;
+    // Add one position as temp position for MAP-elites (plus one per batched offspring)
+    phen_cache.Resize(GetSize() + 1 + MAPE_BATCH_SIZE, EVAL_TRIAL_CNT, phen_layout);
+    phen_valid.resize(GetSize() + 1);
+    InvalidatePhenotypes();
+    temp_phen_org = nullptr;
   });
 
 }
@@ -1558,8 +2322,9 @@ void MapElitesSignalGPWorld::Run() {
       // Well-mixed world mode does the same thing as MAPE-mode during a run. (we leave the break out and drop into MAPE case)
     case (size_t)WORLD_MODE::MAPE: {
       do_begin_run_sig.Trigger();
-      do_pop_init_sig.Trigger();
-      for (size_t u = 0; u <= GENERATIONS; ++u) {
+      if (resuming) RestoreCheckpoint();
+      else do_pop_init_sig.Trigger();
+      for (size_t u = GetUpdate(); u <= GENERATIONS; ++u) {
         RunStep();
       }
       break;
@@ -1572,10 +2337,21 @@ void MapElitesSignalGPWorld::Run() {
 }
 
 void MapElitesSignalGPWorld::RunStep() {
+  // When checkpointing, every update draws from its own world random number stream (so we can restart mid-run).
+  if (CHECKPOINT_INTERVAL || resuming) random_ptr->ResetSeed(DeriveStreamSeed(run_seed, {(uint64_t)GetUpdate()}));
+  // Phase timing: with MAP-Elites, offspring are evaluated during selection.
+  const size_t cur_update = GetUpdate();
+  ResetEvalCnt();
+  phase_timer.Start();
   // could move these onto OnUpdate signal
   do_evaluation_sig.Trigger();
+  phase_timer.Mark(UPDATE_PHASE::EVALUATION);
   do_selection_sig.Trigger();
+  phase_timer.Mark(UPDATE_PHASE::SELECTION);
   do_world_update_sig.Trigger();
+  phase_timer.Mark(UPDATE_PHASE::UPDATE);
+  if (PHASE_TIMING) phase_timer.PrintRow(phase_timing_ofstream, cur_update, GetEvalCnt());
+  if (CHECKPOINT_INTERVAL && GetUpdate() % CHECKPOINT_INTERVAL == 0) SaveCheckpoint();
 }
 
 // === Changing environment utility functions
@@ -1678,6 +2454,10 @@ void MapElitesSignalGPWorld::InitPop_Ancestor() {
     exit(-1);
   }
   ancestor_prog.Load(ancestor_fstream);
+  if (ancestor_prog.GetSize() > PROG_MAX_FUNC_CNT) {
+    std::cout << "Ancestor program has more functions (" << ancestor_prog.GetSize() << ") than PROG_MAX_FUNC_CNT (" << PROG_MAX_FUNC_CNT << "). Exiting..." << std::endl;
+    exit(-1);
+  }
   std::cout << " --- Ancestor program: ---" << std::endl;
   ancestor_prog.PrintProgramFull();
   std::cout << " -------------------------" << std::endl;
@@ -1690,8 +2470,25 @@ void MapElitesSignalGPWorld::InitPop_Ancestor() {
 void MapElitesSignalGPWorld::Snapshot_Programs() {
   std::string snapshot_dir = DATA_DIRECTORY + "pop_" + emp::to_string(GetUpdate());
   mkdir(snapshot_dir.c_str(), ACCESSPERMS);
+  const std::string fpath = snapshot_dir + "/pop_" + emp::to_string(GetUpdate());
+  switch (POP_SNAPSHOT_FORMAT) {
+    case (size_t)POP_SNAPSHOT_FORMAT::TEXT: Snapshot_ProgramsText(fpath + ".pop"); break;
+    case (size_t)POP_SNAPSHOT_FORMAT::BINARY: Snapshot_ProgramsBinary(fpath + ".popb"); break;
+    case (size_t)POP_SNAPSHOT_FORMAT::BOTH: {
+      Snapshot_ProgramsText(fpath + ".pop");
+      Snapshot_ProgramsBinary(fpath + ".popb");
+      break;
+    }
+    default: {
+      std::cout << "Unrecognized POP_SNAPSHOT_FORMAT (" << POP_SNAPSHOT_FORMAT << "). Exiting..." << std::endl;
+      exit(-1);
+    }
+  }
+}
+
+void MapElitesSignalGPWorld::Snapshot_ProgramsText(const std::string & fpath) {
   // For each program in the population, dump the full program description in a single file.
-  std::ofstream prog_ofstream(snapshot_dir + "/pop_" + emp::to_string(GetUpdate()) + ".pop");
+  std::ofstream prog_ofstream(fpath);
   for (size_t i = 0; i < GetSize(); ++i) {
     if (!IsOccupied(i)) continue;
     prog_ofstream << "==={id:" << i << ",fitness:" << CalcFitnessID(i) << ",sim_thresh:" << GetOrg(i).GetTagSimilarityThreshold();
@@ -1708,6 +2505,37 @@ void MapElitesSignalGPWorld::Snapshot_Programs() {
 
 }
 
+void MapElitesSignalGPWorld::Snapshot_ProgramsBinary(const std::string & fpath) {
+  PopSnapshotWriter writer(POP_SNAPSHOT_KIND::SIGNALGP, GetSize(), org_t::TAG_WIDTH, hardware_t::MAX_INST_ARGS, GetUpdate());
+  for (size_t p = 0; p < phen_traits.size(); ++p) {
+    writer.AddAxis(phen_traits[p].name, trait_bin_sizes[phen_traits[p].id]);
+  }
+  for (size_t i = 0; i < inst_lib.GetSize(); ++i) {
+    uint32_t flags = 0;
+    if (inst_lib.HasProperty(i, "block_def")) flags |= POP_SNAPSHOT_INST_FLAG::BLOCK_DEF;
+    if (inst_lib.HasProperty(i, "block_close")) flags |= POP_SNAPSHOT_INST_FLAG::BLOCK_CLOSE;
+    writer.AddInstDef(inst_lib.GetName(i), inst_lib.GetNumArgs(i), flags);
+  }
+  emp::vector<size_t> bins(phen_traits.size());
+  for (size_t i = 0; i < GetSize(); ++i) {
+    if (!IsOccupied(i)) continue;
+    org_t & org = GetOrg(i);
+    for (size_t p = 0; p < phen_traits.size(); ++p) {
+      bins[p] = GetPhenotypes()[phen_traits[p].id].EvalBin(org, trait_bin_sizes[phen_traits[p].id]);
+    }
+    writer.BeginOrg(i, CalcFitnessID(i), org.GetTagSimilarityThreshold(), bins);
+    program_t & prog = org.GetProgram();
+    for (size_t fID = 0; fID < prog.GetSize(); ++fID) {
+      writer.BeginFunction(prog[fID].affinity);
+      for (size_t k = 0; k < prog[fID].GetSize(); ++k) {
+        const inst_t & inst = prog[fID][k];
+        writer.AddInst(inst.id, inst.args, inst.affinity);
+      }
+    }
+  }
+  if (!writer.Save(fpath)) std::cout << "Failed to write population snapshot (" << fpath << ")." << std::endl;
+}
+
 /// Snapshot population statistics for current update.
 void MapElitesSignalGPWorld::Snapshot_PopulationStats() {
   std::string snapshot_dir = DATA_DIRECTORY + "pop_" + emp::to_string((int)GetUpdate());
@@ -1720,14 +2548,12 @@ void MapElitesSignalGPWorld::Snapshot_PopulationStats() {
   file.PrintHeaderKeys();
 
   // Loop through the population, updating file with individuals' stats. 
-  for (pop_snapshot_info.cur_org_id = 0; pop_snapshot_info.cur_org_id < GetSize(); ++pop_snapshot_info.cur_org_id) {
-    if (!IsOccupied(pop_snapshot_info.cur_org_id)) continue;
-    org_t & org = GetOrg(pop_snapshot_info.cur_org_id);
-    org.SetPos(pop_snapshot_info.cur_org_id);
-    Evaluate(org);
-    file.Update();
+  emp::vector<size_t> org_ids;
+  for (size_t id = 0; id < GetSize(); ++id) {
+    if (IsOccupied(id)) org_ids.emplace_back(id);
   }
-
+  size_t evalID = 0;
+  SnapshotEvaluations(file, org_ids, 1, evalID);
 }
 
 /// Snapshot dominant program performance over many trials (only makes sense in context of non-MAPE run). 
@@ -1746,15 +2572,7 @@ void MapElitesSignalGPWorld::Snapshot_Dominant() {
   }
   file.PrintHeaderKeys();
 
-  // emp::vector<double 
-  org_t & dom = GetOrg(dominant_id);
-  dom.SetPos(dominant_id);
-
-  for (size_t evalID = 0; evalID < DOM_SNAPSHOT_TRIAL_CNT; ++evalID) {
-    Evaluate(dom);
-    file.Update();
-  }
-  
+  SnapshotEvaluations(file, {dominant_id}, DOM_SNAPSHOT_TRIAL_CNT, evalID);
 }
 
 /// Snapshot map from MAP-elites (only makes sense in context of MAP-Elites run). 
@@ -1774,29 +2592,132 @@ void MapElitesSignalGPWorld::Snapshot_MAP(void) {
   
   file.PrintHeaderKeys();
 
+  emp::vector<size_t> org_ids;
   for (size_t orgID = 0; orgID < GetSize(); ++orgID) {
-    if (!IsOccupied(orgID)) continue;
-    for (evalID = 0; evalID < MAP_SNAPSHOT_TRIAL_CNT; ++evalID) {
-      org_t & org = GetOrg(orgID);
-      org.SetPos(orgID);
-      Evaluate(org);
-      file.Update();
-    }
+    if (IsOccupied(orgID)) org_ids.emplace_back(orgID);
   }
+  SnapshotEvaluations(file, org_ids, MAP_SNAPSHOT_TRIAL_CNT, evalID);
 }
 
 /// Add a data file to track dominant program. Will track at same interval as fitness file. (only makes sense in context of non-MAPE run).
 emp::DataFile & MapElitesSignalGPWorld::AddDominantFile(const std::string & fpath="dominant.csv") {
-  auto & file = SetupFile(fpath);
+  auto & file = AddDataFile(ckpt_files.OpenDataFile(fpath));
 
   // TODO: convert to dom_stats thing
   for (size_t i = 0; i < dom_file_stats.size(); ++i) {
     file.AddFun(dom_file_stats[i].fun, dom_file_stats[i].name, dom_file_stats[i].desc);
   }
 
-  file.PrintHeaderKeys();
+  if (!ckpt_files.IsResuming(fpath)) file.PrintHeaderKeys();
   return file;
 }
 
 
+// === Checkpoint functions ===
+/// Checkpoints are taken at the end of an update (after the world update); they hold everything that the next update
+/// depends on: the population (or MAP), cached fitnesses and phenotypes, problem state, and data file lengths. 
+void MapElitesSignalGPWorld::SaveCheckpoint() {
+  CheckpointWriter ckpt(CHECKPOINT_KIND::SIGNALGP);
+  ckpt.Put(run_seed);
+  ckpt.Put((uint64_t)GetUpdate());
+  ckpt_files.Save(ckpt);
+  // Problem state
+  SaveTags(ckpt, chgenv_info.env_state_tags);
+  SaveTags(ckpt, chgenv_info.distraction_sig_tags);
+  ckpt.PutVector(testcase_ids);
+  ckpt.Put((uint8_t)mape_dense_select);
+  // Population
+  ckpt.Put((uint64_t)GetSize());
+  for (size_t id = 0; id < GetSize(); ++id) {
+    ckpt.Put((uint8_t)IsOccupied(id));
+    if (IsOccupied(id)) SaveGenome(ckpt, GetOrg(id).GetGenome());
+  }
+  ckpt.PutVector(fit_cache);
+  ckpt.PutVector(fitness_node_vals);
+  // Phenotypes
+  ckpt.Put((uint64_t)phen_cache.GetOrgCnt());
+  phen_cache.ForEachColumn([&ckpt](const auto & col) { ckpt.PutVector(col); });
+  ckpt.PutVector(phen_valid);
+  if (!ckpt.Save(checkpoint_fpath)) std::cout << "Failed to write checkpoint (" << checkpoint_fpath << ")." << std::endl;
+}
+
+void MapElitesSignalGPWorld::RestoreCheckpoint() {
+  CheckpointReader & ckpt = resume_ckpt;
+  // Problem state
+  LoadTags(ckpt, chgenv_info.env_state_tags);
+  LoadTags(ckpt, chgenv_info.distraction_sig_tags);
+  for (size_t i = 0; i < eval_ctxs.size(); ++i) eval_ctxs[i]->chgenv_info = chgenv_info;
+  ckpt.GetVector(testcase_ids);
+  mape_dense_select = ckpt.Get<uint8_t>();
+  // Population
+  const uint64_t pop_size = ckpt.Get<uint64_t>();
+  bool valid = true;
+  for (size_t id = 0; id < pop_size && ckpt.IsOK() && valid; ++id) {
+    if (!ckpt.Get<uint8_t>()) continue;
+    program_t prog(&inst_lib);
+    double sim_thresh = 0;
+    valid = LoadGenome(ckpt, prog, sim_thresh);
+    if (!valid) break;
+    InjectAt(genome_t(prog, sim_thresh), emp::WorldPosition(id));
+  }
+  ckpt.GetVector(fit_cache);
+  ckpt.GetVector(fitness_node_vals);
+  #ifndef EMSCRIPTEN
+  auto & fit_node = GetFitnessDataNode();
+  fit_node.Reset();
+  for (double val : fitness_node_vals) fit_node.Add(val);
+  #endif
+  // Phenotypes (cache must already be sized for this run's configuration)
+  valid = valid && ckpt.Get<uint64_t>() == phen_cache.GetOrgCnt();
+  phen_cache.ForEachColumn([&ckpt, &valid](auto & col) {
+    const size_t expected = col.size();
+    ckpt.GetVector(col);
+    valid = valid && col.size() == expected;
+  });
+  ckpt.GetVector(phen_valid);
+  temp_phen_org = nullptr;
+  if (!ckpt.IsOK() || !valid || GetSize() != pop_size) {
+    std::cout << "Failed to restore world from checkpoint (" << checkpoint_fpath << "). Exiting..." << std::endl;
+    exit(-1);
+  }
+}
+
+void MapElitesSignalGPWorld::SaveGenome(CheckpointWriter & ckpt, genome_t & genome) {
+  program_t & prog = genome.program;
+  ckpt.Put(genome.tag_sim_thresh);
+  ckpt.Put((uint64_t)prog.GetSize());
+  for (size_t fID = 0; fID < prog.GetSize(); ++fID) {
+    for (size_t i = 0; i < TAG_WORD_CNT; ++i) ckpt.Put((uint32_t)prog[fID].affinity.GetUInt(i));
+    ckpt.Put((uint64_t)prog[fID].GetSize());
+    for (size_t k = 0; k < prog[fID].GetSize(); ++k) {
+      const inst_t & inst = prog[fID][k];
+      ckpt.Put((uint32_t)inst.id);
+      for (size_t a = 0; a < hardware_t::MAX_INST_ARGS; ++a) ckpt.Put((int32_t)inst.args[a]);
+      for (size_t i = 0; i < TAG_WORD_CNT; ++i) ckpt.Put((uint32_t)inst.affinity.GetUInt(i));
+    }
+  }
+}
+
+/// Load a genome (written by SaveGenome) into prog/sim_thresh. Returns false if checkpoint is malformed.
+bool MapElitesSignalGPWorld::LoadGenome(CheckpointReader & ckpt, program_t & prog, double & sim_thresh) {
+  sim_thresh = ckpt.Get<double>();
+  const uint64_t func_cnt = ckpt.Get<uint64_t>();
+  for (size_t fID = 0; fID < func_cnt && ckpt.IsOK(); ++fID) {
+    tag_t func_tag;
+    for (size_t i = 0; i < TAG_WORD_CNT; ++i) func_tag.SetUInt(i, ckpt.Get<uint32_t>());
+    prog.PushFunction(func_tag);
+    const uint64_t inst_cnt = ckpt.Get<uint64_t>();
+    for (size_t k = 0; k < inst_cnt && ckpt.IsOK(); ++k) {
+      const size_t id = ckpt.Get<uint32_t>();
+      int32_t args[hardware_t::MAX_INST_ARGS];
+      for (size_t a = 0; a < hardware_t::MAX_INST_ARGS; ++a) args[a] = ckpt.Get<int32_t>();
+      tag_t inst_tag;
+      for (size_t i = 0; i < TAG_WORD_CNT; ++i) inst_tag.SetUInt(i, ckpt.Get<uint32_t>());
+      if (id >= inst_lib.GetSize()) return false;
+      prog[fID].PushInst(inst_t(id, args[0], args[1], args[2], inst_tag));
+    }
+  }
+  return ckpt.IsOK();
+}
+
 #endif
\ No newline at end of file
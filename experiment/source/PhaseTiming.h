@@ -0,0 +1,63 @@
+#ifndef MAPEGP_PHASE_TIMING_H
+#define MAPEGP_PHASE_TIMING_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+#include "base/vector.h"
+
+/// Phases of a world update (see PhaseTimer).
+enum class UPDATE_PHASE : size_t { EVALUATION=0, SELECTION=1, UPDATE=2 };
+
+/// Wall-clock time spent in each phase of a single update (written one row per update to phase_timing.csv).
+///  - Start() at the beginning of the update; Mark(phase) at the end of each phase charges it the time since the
+///    previous Start/Mark.
+///  - Rows: update, seconds per phase, total seconds, evaluations run during the update.
+class PhaseTimer {
+protected:
+  using timer_clock_t = std::chrono::steady_clock;
+
+  emp::vector<std::string> phases;
+  emp::vector<double> secs;          ///< Seconds charged to each phase since the last Start.
+  timer_clock_t::time_point last;    ///< Time of the last Start/Mark.
+
+public:
+  PhaseTimer(const emp::vector<std::string> & _phases={"evaluation", "selection", "update"})
+    : phases(_phases), secs(_phases.size(), 0.0), last(timer_clock_t::now()) { ; }
+
+  size_t GetPhaseCnt() const { return phases.size(); }
+  double GetTime(size_t phase_id) const { return secs[phase_id]; }
+
+  double GetTotalTime() const {
+    double total = 0.0;
+    for (double s : secs) total += s;
+    return total;
+  }
+
+  void Start() {
+    for (double & s : secs) s = 0.0;
+    last = timer_clock_t::now();
+  }
+
+  void Mark(size_t phase_id) {
+    const timer_clock_t::time_point now = timer_clock_t::now();
+    secs[phase_id] += std::chrono::duration<double>(now - last).count();
+    last = now;
+  }
+  void Mark(UPDATE_PHASE phase) { Mark((size_t)phase); }
+
+  void PrintHeader(std::ostream & os) const {
+    os << "update";
+    for (const std::string & phase : phases) os << "," << phase << "_sec";
+    os << ",total_sec,evals" << std::endl;
+  }
+
+  void PrintRow(std::ostream & os, size_t update, size_t evals) const {
+    os << update;
+    for (double s : secs) os << "," << s;
+    os << "," << GetTotalTime() << "," << evals << std::endl;
+  }
+};
+
+#endif
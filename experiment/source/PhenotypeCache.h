@@ -1,42 +1,322 @@
 #ifndef MAPEGP_PHENCACHE_H
 #define MAPEGP_PHENCACHE_H
 
-  /// Utility class used to cache phenotypes during population evaluation.
-  template <typename PHENOTYPE_INFO>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "base/assert.h"
+#include "base/vector.h"
+
+  /// Running tally of function entries (calls/spawns) during a single evaluation.
+  ///  - Memory is proportional to the number of functions (not to how many times they're entered).
+  ///  - Reset is proportional to the number of distinct functions entered; nothing allocates after Resize.
+  struct FunctionEntryCounts {
+    emp::vector<size_t> entries;  ///< Number of times each function was entered.
+    emp::vector<size_t> used;     ///< Functions entered at least once (in order of first entry).
+    size_t total;                 ///< Total number of entries.
+
+    FunctionEntryCounts(size_t func_cnt=0) : entries(), used(), total(0) { Resize(func_cnt); }
+
+    void Resize(size_t func_cnt) {
+      entries.assign(func_cnt, 0);
+      used.clear();
+      used.reserve(func_cnt);
+      total = 0;
+    }
+
+    void Reset() {
+      for (size_t i = 0; i < used.size(); ++i) entries[used[i]] = 0;
+      used.clear();
+      total = 0;
+    }
+
+    void Record(size_t fID) {
+      emp_assert(fID < entries.size(), fID, entries.size());
+      if (entries[fID]++ == 0) used.emplace_back(fID);
+      ++total;
+    }
+  };
+
+  /// Utility class used to cache (SignalGP) phenotypes during population evaluation.
+  ///  - Phenotypes are stored column-wise in flat arrays, with one row per (organism, evaluation).
+  ///  - Every row has a fixed width (given by the cache layout), so the cache only allocates when it is resized.
+  ///    Resetting and filling out phenotypes during evaluation never touches the heap.
+  ///  - Get(org_id, eval_id) returns a Phenotype: a lightweight view into a row of the cache.
   class PhenotypeCache {
     public:
-      using phenotype_t = PHENOTYPE_INFO;
+      /// Row widths for variable-length phenotype traits.
+      struct Layout {
+        size_t func_cnt;      ///< Max number of functions in a program.
+        size_t env_cnt;       ///< Number of environment states (changing environment problem).
+        size_t testcase_cnt;  ///< Number of testcases per evaluation (testcase problem).
+        size_t task_cnt;      ///< Number of tasks (logic problem).
+
+        Layout(size_t _func_cnt=0, size_t _env_cnt=0, size_t _testcase_cnt=0, size_t _task_cnt=0)
+          : func_cnt(_func_cnt), env_cnt(_env_cnt), testcase_cnt(_testcase_cnt), task_cnt(_task_cnt) { ; }
+
+        size_t GetFuncWordCnt() const { return (func_cnt + 63) / 64; }
+      };
+
+      /// View of a single phenotype (one row of the cache).
+      struct Phenotype {
+        const Layout & layout;
+        // Generic
+        double & score;
+        size_t & functions_used_cnt;      ///< Number of unique functions used.
+        size_t & functions_entered_cnt;   ///< Number of function entries (repeats allowed).
+        uint64_t * functions_used;        ///< Bitset: which functions were used?
+        size_t * function_entries;        ///< Number of times each function was entered.
+        // For changing environment problem
+        double & env_match_score;
+        size_t * matches_by_env;
+        size_t * time_by_env;
+        // For testcase problems
+        size_t & testcase_result_cnt;
+        double * testcase_results;
+        size_t * testcase_steps;          ///< Number of hardware steps actually executed on each testcase.
+        // For logic problem
+        size_t & time_all_logic_tasks_done;
+        size_t & unique_logic_tasks_done;
+        size_t * logic_tasks_done_by_task;
+
+        void Reset() {
+          score = 0;
+          functions_used_cnt = 0;
+          functions_entered_cnt = 0;
+          for (size_t i = 0; i < layout.GetFuncWordCnt(); ++i) functions_used[i] = 0;
+          for (size_t i = 0; i < layout.func_cnt; ++i) function_entries[i] = 0;
+
+          env_match_score = 0;
+          for (size_t i = 0; i < layout.env_cnt; ++i) matches_by_env[i] = 0;
+          for (size_t i = 0; i < layout.env_cnt; ++i) time_by_env[i] = 0;
+
+          testcase_result_cnt = 0;
+
+          time_all_logic_tasks_done = 0;
+          unique_logic_tasks_done = 0;
+          for (size_t i = 0; i < layout.task_cnt; ++i) logic_tasks_done_by_task[i] = 0;
+        }
+
+        /// Overwrite function usage info with the given tally (phenotype must not have any function entries yet).
+        void SetFunctionEntries(const FunctionEntryCounts & counts) {
+          emp_assert(functions_entered_cnt == 0);
+          for (size_t i = 0; i < counts.used.size(); ++i) {
+            const size_t fID = counts.used[i];
+            emp_assert(fID < layout.func_cnt, fID, layout.func_cnt);
+            functions_used[fID / 64] |= ((uint64_t)1) << (fID % 64);
+            function_entries[fID] = counts.entries[fID];
+          }
+          functions_used_cnt = counts.used.size();
+          functions_entered_cnt = counts.total;
+        }
+
+        bool UsedFunction(size_t fID) const {
+          emp_assert(fID < layout.func_cnt, fID, layout.func_cnt);
+          return functions_used[fID / 64] & (((uint64_t)1) << (fID % 64));
+        }
+
+        /// Shannon entropy (bits) of functions entered.
+        double GetFunctionEntryEntropy() const {
+          if (functions_entered_cnt == 0) return 0.0;
+          double entropy = 0;
+          for (size_t i = 0; i < layout.func_cnt; ++i) {
+            if (function_entries[i] == 0) continue;
+            const double p = function_entries[i] / (double)functions_entered_cnt;
+            entropy -= p * std::log2(p);
+          }
+          return entropy;
+        }
+
+        void AddTestcaseResult(double result, size_t steps) {
+          emp_assert(testcase_result_cnt < layout.testcase_cnt, testcase_result_cnt, layout.testcase_cnt);
+          testcase_steps[testcase_result_cnt] = steps;
+          testcase_results[testcase_result_cnt++] = result;
+        }
+
+        double GetTestcaseResultTotal() const {
+          double total = 0;
+          for (size_t i = 0; i < testcase_result_cnt; ++i) total += testcase_results[i];
+          return total;
+        }
+
+        size_t GetTestcaseStepTotal() const {
+          size_t total = 0;
+          for (size_t i = 0; i < testcase_result_cnt; ++i) total += testcase_steps[i];
+          return total;
+        }
+      };
+
+      using phenotype_t = Phenotype;
+
     protected:
-      size_t org_cnt;   ///< How many organisms do we need to track? 
-      size_t eval_cnt;  ///< How many evaluations per organism are we tracking? 
+      size_t org_cnt;   ///< How many organisms do we need to track?
+      size_t eval_cnt;  ///< How many evaluations per organism are we tracking?
+      Layout layout;
+
+      // Phenotype columns (row = org_id * eval_cnt + eval_id).
+      emp::vector<double> score;
+      emp::vector<size_t> functions_used_cnt;
+      emp::vector<size_t> functions_entered_cnt;
+      emp::vector<uint64_t> functions_used;         ///< layout.GetFuncWordCnt() per row
+      emp::vector<size_t> function_entries;         ///< layout.func_cnt per row
+      emp::vector<double> env_match_score;
+      emp::vector<size_t> matches_by_env;           ///< layout.env_cnt per row
+      emp::vector<size_t> time_by_env;              ///< layout.env_cnt per row
+      emp::vector<size_t> testcase_result_cnt;
+      emp::vector<double> testcase_results;         ///< layout.testcase_cnt per row
+      emp::vector<size_t> testcase_steps;           ///< layout.testcase_cnt per row
+      emp::vector<size_t> time_all_logic_tasks_done;
+      emp::vector<size_t> unique_logic_tasks_done;
+      emp::vector<size_t> logic_tasks_done_by_task; ///< layout.task_cnt per row
+
+      size_t GetRow(size_t org_id, size_t eval_id) const {
+        emp_assert(org_id < org_cnt);
+        emp_assert(eval_id < eval_cnt);
+        return (org_id * eval_cnt) + eval_id;
+      }
+
+      /// Copy all columns of row 'from' in src to row 'to' in this cache (layouts must match).
+      void CopyRow(size_t to, const PhenotypeCache & src, size_t from) {
+        const size_t fw = layout.GetFuncWordCnt(), fc = layout.func_cnt, ec = layout.env_cnt;
+        const size_t tc = layout.testcase_cnt, kc = layout.task_cnt;
+        score[to] = src.score[from];
+        functions_used_cnt[to] = src.functions_used_cnt[from];
+        functions_entered_cnt[to] = src.functions_entered_cnt[from];
+        for (size_t i = 0; i < fw; ++i) functions_used[to*fw+i] = src.functions_used[from*fw+i];
+        for (size_t i = 0; i < fc; ++i) function_entries[to*fc+i] = src.function_entries[from*fc+i];
+        env_match_score[to] = src.env_match_score[from];
+        for (size_t i = 0; i < ec; ++i) matches_by_env[to*ec+i] = src.matches_by_env[from*ec+i];
+        for (size_t i = 0; i < ec; ++i) time_by_env[to*ec+i] = src.time_by_env[from*ec+i];
+        testcase_result_cnt[to] = src.testcase_result_cnt[from];
+        for (size_t i = 0; i < tc; ++i) testcase_results[to*tc+i] = src.testcase_results[from*tc+i];
+        for (size_t i = 0; i < tc; ++i) testcase_steps[to*tc+i] = src.testcase_steps[from*tc+i];
+        time_all_logic_tasks_done[to] = src.time_all_logic_tasks_done[from];
+        unique_logic_tasks_done[to] = src.unique_logic_tasks_done[from];
+        for (size_t i = 0; i < kc; ++i) logic_tasks_done_by_task[to*kc+i] = src.logic_tasks_done_by_task[from*kc+i];
+      }
+
+      /// Are rows 'a' (in this cache) and 'b' (in other) identical? Only compares testcase results that have been filled out.
+      bool SameRow(size_t a, const PhenotypeCache & other, size_t b) const {
+        const size_t fw = layout.GetFuncWordCnt(), fc = layout.func_cnt, ec = layout.env_cnt;
+        const size_t tc = layout.testcase_cnt, kc = layout.task_cnt;
+        if (score[a] != other.score[b]) return false;
+        if (functions_used_cnt[a] != other.functions_used_cnt[b]) return false;
+        if (functions_entered_cnt[a] != other.functions_entered_cnt[b]) return false;
+        for (size_t i = 0; i < fw; ++i) if (functions_used[a*fw+i] != other.functions_used[b*fw+i]) return false;
+        for (size_t i = 0; i < fc; ++i) if (function_entries[a*fc+i] != other.function_entries[b*fc+i]) return false;
+        if (env_match_score[a] != other.env_match_score[b]) return false;
+        for (size_t i = 0; i < ec; ++i) if (matches_by_env[a*ec+i] != other.matches_by_env[b*ec+i]) return false;
+        for (size_t i = 0; i < ec; ++i) if (time_by_env[a*ec+i] != other.time_by_env[b*ec+i]) return false;
+        if (testcase_result_cnt[a] != other.testcase_result_cnt[b]) return false;
+        for (size_t i = 0; i < testcase_result_cnt[a]; ++i) if (testcase_results[a*tc+i] != other.testcase_results[b*tc+i]) return false;
+        for (size_t i = 0; i < testcase_result_cnt[a]; ++i) if (testcase_steps[a*tc+i] != other.testcase_steps[b*tc+i]) return false;
+        if (time_all_logic_tasks_done[a] != other.time_all_logic_tasks_done[b]) return false;
+        if (unique_logic_tasks_done[a] != other.unique_logic_tasks_done[b]) return false;
+        for (size_t i = 0; i < kc; ++i) if (logic_tasks_done_by_task[a*kc+i] != other.logic_tasks_done_by_task[b*kc+i]) return false;
+        return true;
+      }
 
-      emp::vector<phenotype_t> phen_cache;
-      
     public:
-      PhenotypeCache(size_t _org_cnt=0, size_t _eval_cnt=0) 
-        : org_cnt(_org_cnt), eval_cnt(_eval_cnt),
-          phen_cache(org_cnt*eval_cnt)
-      { ; }
+      PhenotypeCache(size_t _org_cnt=0, size_t _eval_cnt=0, const Layout & _layout=Layout())
+        : org_cnt(0), eval_cnt(0), layout(),
+          score(), functions_used_cnt(), functions_entered_cnt(), functions_used(), function_entries(),
+          env_match_score(), matches_by_env(), time_by_env(), testcase_result_cnt(), testcase_results(), testcase_steps(),
+          time_all_logic_tasks_done(), unique_logic_tasks_done(), logic_tasks_done_by_task()
+      {
+        Resize(_org_cnt, _eval_cnt, _layout);
+      }
 
-      /// Resize phenotype cache. 
-      void Resize(size_t _org_cnt, size_t _eval_cnt=1) {
+      /// Resize phenotype cache (all phenotypes are zeroed out).
+      void Resize(size_t _org_cnt, size_t _eval_cnt, const Layout & _layout) {
         org_cnt = _org_cnt;
         eval_cnt = _eval_cnt;
-        phen_cache.clear();
-        phen_cache.resize(org_cnt * eval_cnt);
+        layout = _layout;
+        const size_t rows = org_cnt * eval_cnt;
+        score.assign(rows, 0);
+        functions_used_cnt.assign(rows, 0);
+        functions_entered_cnt.assign(rows, 0);
+        functions_used.assign(rows * layout.GetFuncWordCnt(), 0);
+        function_entries.assign(rows * layout.func_cnt, 0);
+        env_match_score.assign(rows, 0);
+        matches_by_env.assign(rows * layout.env_cnt, 0);
+        time_by_env.assign(rows * layout.env_cnt, 0);
+        testcase_result_cnt.assign(rows, 0);
+        testcase_results.assign(rows * layout.testcase_cnt, 0);
+        testcase_steps.assign(rows * layout.testcase_cnt, 0);
+        time_all_logic_tasks_done.assign(rows, 0);
+        unique_logic_tasks_done.assign(rows, 0);
+        logic_tasks_done_by_task.assign(rows * layout.task_cnt, 0);
       }
 
+      size_t GetOrgCnt() const { return org_cnt; }
+      size_t GetEvalCnt() const { return eval_cnt; }
+      const Layout & GetLayout() const { return layout; }
+
       /// Access a phenotype from the cache
-      phenotype_t & Get(size_t org_id, size_t eval_id) {
-        emp_assert(org_id < org_cnt);
-        emp_assert(eval_id < eval_cnt); 
-        return phen_cache[(org_id * eval_cnt) + eval_id];
+      Phenotype Get(size_t org_id, size_t eval_id) {
+        const size_t row = GetRow(org_id, eval_id);
+        return Phenotype{ layout,
+                          score[row], functions_used_cnt[row], functions_entered_cnt[row],
+                          functions_used.data() + row * layout.GetFuncWordCnt(),
+                          function_entries.data() + row * layout.func_cnt,
+                          env_match_score[row],
+                          matches_by_env.data() + row * layout.env_cnt,
+                          time_by_env.data() + row * layout.env_cnt,
+                          testcase_result_cnt[row],
+                          testcase_results.data() + row * layout.testcase_cnt,
+                          testcase_steps.data() + row * layout.testcase_cnt,
+                          time_all_logic_tasks_done[row], unique_logic_tasks_done[row],
+                          logic_tasks_done_by_task.data() + row * layout.task_cnt };
+      }
+
+      /// Scores for every evaluation of an organism (contiguous; GetEvalCnt() of them).
+      const double * GetScores(size_t org_id) const { return score.data() + GetRow(org_id, 0); }
+
+      /// Unique function counts for every evaluation of an organism (contiguous; GetEvalCnt() of them).
+      const size_t * GetFunctionsUsedCnts(size_t org_id) const { return functions_used_cnt.data() + GetRow(org_id, 0); }
+
+      /// Worst (min) result on each testcase across all of an organism's evaluations; writes layout.testcase_cnt values to out.
+      void GetMinTestcaseResults(size_t org_id, double * out) const {
+        const size_t tc = layout.testcase_cnt;
+        const double * results = testcase_results.data() + GetRow(org_id, 0) * tc;
+        for (size_t i = 0; i < tc; ++i) out[i] = results[i];
+        for (size_t eval_id = 1; eval_id < eval_cnt; ++eval_id) {
+          const double * eval_results = results + eval_id * tc;
+          for (size_t i = 0; i < tc; ++i) out[i] = std::min(out[i], eval_results[i]);
+        }
       }
 
-      emp::vector<phenotype_t> & GetCache() {
-        return phen_cache;
+      /// Copy all of an organism's phenotypes (every evaluation) from src into this cache.
+      void CopyOrg(size_t to_org, const PhenotypeCache & src, size_t from_org) {
+        emp_assert(eval_cnt == src.eval_cnt);
+        emp_assert(layout.func_cnt == src.layout.func_cnt && layout.env_cnt == src.layout.env_cnt
+                   && layout.testcase_cnt == src.layout.testcase_cnt && layout.task_cnt == src.layout.task_cnt);
+        for (size_t eval_id = 0; eval_id < eval_cnt; ++eval_id) {
+          CopyRow(GetRow(to_org, eval_id), src, src.GetRow(from_org, eval_id));
+        }
       }
-    
+
+      /// Call fun on every phenotype column, always in the same order (e.g., to save/load the cache).
+      template <typename FUN>
+      void ForEachColumn(FUN && fun) {
+        fun(score); fun(functions_used_cnt); fun(functions_entered_cnt); fun(functions_used); fun(function_entries);
+        fun(env_match_score); fun(matches_by_env); fun(time_by_env);
+        fun(testcase_result_cnt); fun(testcase_results); fun(testcase_steps);
+        fun(time_all_logic_tasks_done); fun(unique_logic_tasks_done); fun(logic_tasks_done_by_task);
+      }
+
+      /// Are all of an organism's phenotypes (every evaluation) identical to another organism's phenotypes?
+      bool SameOrg(size_t org_id, const PhenotypeCache & other, size_t other_org) const {
+        emp_assert(eval_cnt == other.eval_cnt);
+        emp_assert(layout.func_cnt == other.layout.func_cnt && layout.env_cnt == other.layout.env_cnt
+                   && layout.testcase_cnt == other.layout.testcase_cnt && layout.task_cnt == other.layout.task_cnt);
+        for (size_t eval_id = 0; eval_id < eval_cnt; ++eval_id) {
+          if (!SameRow(GetRow(org_id, eval_id), other, other.GetRow(other_org, eval_id))) return false;
+        }
+        return true;
+      }
+
   };
 
-#endif
\ No newline at end of file
+#endif
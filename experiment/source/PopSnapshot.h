@@ -0,0 +1,360 @@
+#ifndef MAPEGP_POP_SNAPSHOT_H
+#define MAPEGP_POP_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifndef EMSCRIPTEN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "base/assert.h"
+#include "base/vector.h"
+
+/// Binary population snapshot (.popb) format.
+///  - Every field is little-endian, and every record starts on an 8-byte boundary, so readers can mmap
+///    the file and use it in place.
+///  - Layout: [Header][metadata][cell index][org records...]
+///    - Header: fixed 64 bytes (see PopSnapshotHeader).
+///    - Metadata: MAP axes (uint32 bin count, uint32 name length, name), then the instruction library
+///      (uint32 arg count, uint32 flags, uint32 name length, name); each entry padded to 4 bytes, the section to 8.
+///    - Cell index: uint64 file offset of the org record for every world cell (0 => empty cell).
+///    - Org record: double fitness, double sim_thresh, uint32 cell, uint32 function count,
+///      uint32 bins[axis_cnt] (padded to 8 bytes), then for each function: uint32 tag[tag words],
+///      uint32 instruction count, and per instruction: uint32 id, int32 args[arg_cnt], uint32 tag[tag words].
+///  - Linear genomes (ScopeGP/AvidaGP) are stored as a single function with zero-width tags.
+///  - Bump POP_SNAPSHOT_VERSION on any layout change; scripts/popsnapshot.py reads/writes the same layout.
+constexpr char POP_SNAPSHOT_MAGIC[8] = {'M','A','P','E','P','O','P','B'};
+constexpr uint32_t POP_SNAPSHOT_VERSION = 1;
+
+enum class POP_SNAPSHOT_KIND : uint32_t { SIGNALGP=0, AVIDAGP=1 };
+
+/// Instruction library flags (only needed to pretty-print programs).
+enum POP_SNAPSHOT_INST_FLAG : uint32_t { BLOCK_DEF=1, BLOCK_CLOSE=2 };
+
+/// Which program snapshot file(s) to write (POP_SNAPSHOT_FORMAT config setting).
+enum class POP_SNAPSHOT_FORMAT { TEXT=0, BINARY=1, BOTH=2 };
+
+struct PopSnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t kind;          ///< POP_SNAPSHOT_KIND
+  uint64_t update;
+  uint64_t cell_cnt;      ///< Number of world cells (entries in the cell index).
+  uint64_t org_cnt;       ///< Number of occupied cells.
+  uint32_t axis_cnt;      ///< Number of MAP axes (bin coordinates stored per org).
+  uint32_t tag_width;     ///< Tag width in bits (0 => no tags).
+  uint32_t arg_cnt;       ///< Arguments stored per instruction.
+  uint32_t inst_lib_cnt;  ///< Number of instructions in the instruction library.
+  uint64_t meta_bytes;    ///< Size of metadata section (follows header).
+};
+static_assert(sizeof(PopSnapshotHeader) == 64, "PopSnapshotHeader must be 64 bytes.");
+
+/// Build a binary population snapshot, one organism at a time, and then save it.
+/// Usage: AddAxis/AddInstDef (metadata), then for each organism: BeginOrg, (BeginFunction, AddInst...)...
+class PopSnapshotWriter {
+protected:
+  /// Stand-in tag for untagged programs.
+  struct NoTag { uint32_t GetUInt(size_t) const { return 0; } };
+
+  PopSnapshotHeader header;
+  emp::vector<unsigned char> meta;
+  emp::vector<uint64_t> cell_index;   ///< Offsets relative to start of record section (fixed up in Save).
+  emp::vector<unsigned char> records;
+  size_t func_cnt_pos;                ///< Where to write the current org's function count.
+  size_t inst_cnt_pos;                ///< Where to write the current function's instruction count.
+
+  template <typename T>
+  static void Put(emp::vector<unsigned char> & buf, T val) {
+    const size_t pos = buf.size();
+    buf.resize(pos + sizeof(T));
+    std::memcpy(&buf[pos], &val, sizeof(T));
+  }
+  template <typename T>
+  static void PutAt(emp::vector<unsigned char> & buf, size_t pos, T val) { std::memcpy(&buf[pos], &val, sizeof(T)); }
+  static void Pad(emp::vector<unsigned char> & buf, size_t align) { while (buf.size() % align) buf.emplace_back(0); }
+  static void PutName(emp::vector<unsigned char> & buf, const std::string & name) {
+    Put(buf, (uint32_t)name.size());
+    buf.insert(buf.end(), name.begin(), name.end());
+    Pad(buf, 4);
+  }
+
+  /// Write tag (any type with GetUInt, e.g. emp::BitSet) as 32-bit words.
+  template <typename TAG_T>
+  void PutTag(const TAG_T & tag) {
+    for (size_t i = 0; i < GetTagWordCnt(); ++i) Put(records, (uint32_t)tag.GetUInt(i));
+  }
+
+public:
+  PopSnapshotWriter(POP_SNAPSHOT_KIND kind, size_t cell_cnt, size_t tag_width, size_t arg_cnt, size_t update)
+    : header(), meta(), cell_index(cell_cnt, 0), records(), func_cnt_pos(0), inst_cnt_pos(0)
+  {
+    std::memcpy(header.magic, POP_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = POP_SNAPSHOT_VERSION;
+    header.kind = (uint32_t)kind;
+    header.update = update;
+    header.cell_cnt = cell_cnt;
+    header.org_cnt = 0;
+    header.axis_cnt = 0;
+    header.tag_width = (uint32_t)tag_width;
+    header.arg_cnt = (uint32_t)arg_cnt;
+    header.inst_lib_cnt = 0;
+    header.meta_bytes = 0;
+  }
+
+  size_t GetTagWordCnt() const { return (header.tag_width + 31) / 32; }
+
+  /// Describe a MAP axis. All axes must be added before any organisms.
+  void AddAxis(const std::string & name, size_t bin_cnt) {
+    emp_assert(header.org_cnt == 0 && header.inst_lib_cnt == 0, "Axes must come first.");
+    Put(meta, (uint32_t)bin_cnt);
+    PutName(meta, name);
+    ++header.axis_cnt;
+  }
+
+  /// Describe an instruction (in instruction library id order).
+  void AddInstDef(const std::string & name, size_t num_args, uint32_t flags=0) {
+    emp_assert(header.org_cnt == 0, "Instruction library must be described before any organisms.");
+    Put(meta, (uint32_t)num_args);
+    Put(meta, flags);
+    PutName(meta, name);
+    ++header.inst_lib_cnt;
+  }
+
+  /// Start a new organism record for the given world cell.
+  void BeginOrg(size_t cell, double fitness, double sim_thresh, const emp::vector<size_t> & bins) {
+    emp_assert(cell < cell_index.size(), cell);
+    emp_assert(bins.size() == header.axis_cnt, bins.size());
+    Pad(records, 8);
+    cell_index[cell] = records.size() + 1; // +1 so that 0 can still mean 'empty'.
+    ++header.org_cnt;
+    Put(records, fitness);
+    Put(records, sim_thresh);
+    Put(records, (uint32_t)cell);
+    func_cnt_pos = records.size();
+    Put(records, (uint32_t)0);
+    for (size_t b : bins) Put(records, (uint32_t)b);
+    Pad(records, 8);
+  }
+
+  /// Start a new function (with tag) in the current organism.
+  template <typename TAG_T>
+  void BeginFunction(const TAG_T & tag) {
+    uint32_t func_cnt;
+    std::memcpy(&func_cnt, &records[func_cnt_pos], sizeof(func_cnt));
+    PutAt(records, func_cnt_pos, func_cnt + 1);
+    PutTag(tag);
+    inst_cnt_pos = records.size();
+    Put(records, (uint32_t)0);
+  }
+
+  /// Start a new (untagged) function in the current organism.
+  void BeginFunction() { emp_assert(header.tag_width == 0); BeginFunction(NoTag()); }
+
+  /// Add an instruction to the current function.
+  template <typename ARGS_T, typename TAG_T>
+  void AddInst(size_t id, const ARGS_T & args, const TAG_T & tag) {
+    uint32_t inst_cnt;
+    std::memcpy(&inst_cnt, &records[inst_cnt_pos], sizeof(inst_cnt));
+    PutAt(records, inst_cnt_pos, inst_cnt + 1);
+    Put(records, (uint32_t)id);
+    for (size_t i = 0; i < header.arg_cnt; ++i) Put(records, (int32_t)args[i]);
+    PutTag(tag);
+  }
+
+  /// Add an (untagged) instruction to the current function.
+  template <typename ARGS_T>
+  void AddInst(size_t id, const ARGS_T & args) { emp_assert(header.tag_width == 0); AddInst(id, args, NoTag()); }
+
+  /// Write snapshot to file. Returns false on failure.
+  bool Save(const std::string & fpath) {
+    Pad(meta, 8);
+    Pad(records, 8);
+    header.meta_bytes = meta.size();
+    const uint64_t records_start = sizeof(PopSnapshotHeader) + meta.size() + cell_index.size() * sizeof(uint64_t);
+    emp::vector<uint64_t> offsets(cell_index.size(), 0);
+    for (size_t i = 0; i < cell_index.size(); ++i) {
+      if (cell_index[i]) offsets[i] = records_start + cell_index[i] - 1;
+    }
+    std::ofstream ofs(fpath, std::ios::binary | std::ios::trunc);
+    if (!ofs) return false;
+    ofs.write((const char *)&header, sizeof(header));
+    ofs.write((const char *)meta.data(), (std::streamsize)meta.size());
+    ofs.write((const char *)offsets.data(), (std::streamsize)(offsets.size() * sizeof(uint64_t)));
+    ofs.write((const char *)records.data(), (std::streamsize)records.size());
+    return (bool)ofs;
+  }
+};
+
+/// Read-only view of a binary population snapshot.
+///  - Open maps the file into memory; nothing is parsed up front beyond the header and metadata, so
+///    looking up an organism by cell is a single index read.
+class PopSnapshotReader {
+public:
+  /// View of a single instruction.
+  struct InstView {
+    const unsigned char * data;
+    uint32_t arg_cnt;
+
+    uint32_t GetID() const { return Get<uint32_t>(data); }
+    int32_t GetArg(size_t i) const { emp_assert(i < arg_cnt); return Get<int32_t>(data + 4 + 4*i); }
+    uint32_t GetTagWord(size_t i) const { return Get<uint32_t>(data + 4 + 4*arg_cnt + 4*i); }
+  };
+
+  /// View of a single function.
+  struct FunctionView {
+    const unsigned char * data;
+    uint32_t tag_words;
+    uint32_t arg_cnt;
+
+    uint32_t GetTagWord(size_t i) const { emp_assert(i < tag_words); return Get<uint32_t>(data + 4*i); }
+    uint32_t GetInstCnt() const { return Get<uint32_t>(data + 4*tag_words); }
+    size_t GetInstBytes() const { return 4 * (1 + arg_cnt + tag_words); }
+    InstView GetInst(size_t i) const {
+      emp_assert(i < GetInstCnt());
+      return InstView{data + 4*(tag_words + 1) + i * GetInstBytes(), arg_cnt};
+    }
+    /// Total bytes taken by this function (tag, instruction count, instructions).
+    size_t GetBytes() const { return 4*(tag_words + 1) + GetInstCnt() * GetInstBytes(); }
+  };
+
+  /// View of a single organism.
+  struct OrgView {
+    const unsigned char * data;
+    uint32_t axis_cnt;
+    uint32_t tag_words;
+    uint32_t arg_cnt;
+
+    double GetFitness() const { return Get<double>(data); }
+    double GetSimThresh() const { return Get<double>(data + 8); }
+    uint32_t GetCell() const { return Get<uint32_t>(data + 16); }
+    uint32_t GetFunctionCnt() const { return Get<uint32_t>(data + 20); }
+    uint32_t GetBin(size_t axis) const { emp_assert(axis < axis_cnt); return Get<uint32_t>(data + 24 + 4*axis); }
+    /// Functions are variable length; walk to the requested one.
+    FunctionView GetFunction(size_t fID) const {
+      emp_assert(fID < GetFunctionCnt());
+      const size_t bins_bytes = ((4*axis_cnt + 24 + 7) / 8) * 8 - 24;
+      FunctionView fun{data + 24 + bins_bytes, tag_words, arg_cnt};
+      for (size_t i = 0; i < fID; ++i) fun.data += fun.GetBytes();
+      return fun;
+    }
+  };
+
+protected:
+  const unsigned char * base;
+  size_t size;
+  PopSnapshotHeader header;
+  emp::vector<std::string> axis_names;
+  emp::vector<size_t> axis_sizes;
+  emp::vector<std::string> inst_names;
+  emp::vector<size_t> inst_arg_cnts;
+  emp::vector<size_t> inst_flags;
+  const unsigned char * cell_index;
+
+  template <typename T>
+  static T Get(const unsigned char * ptr) { T val; std::memcpy(&val, ptr, sizeof(T)); return val; }
+
+public:
+  PopSnapshotReader() : base(nullptr), size(0), header(), axis_names(), axis_sizes(),
+                        inst_names(), inst_arg_cnts(), inst_flags(), cell_index(nullptr) { ; }
+  PopSnapshotReader(const PopSnapshotReader &) = delete;
+  PopSnapshotReader & operator=(const PopSnapshotReader &) = delete;
+  ~PopSnapshotReader() { Close(); }
+
+  bool IsOpen() const { return base != nullptr; }
+  const PopSnapshotHeader & GetHeader() const { return header; }
+  size_t GetUpdate() const { return header.update; }
+  size_t GetCellCnt() const { return header.cell_cnt; }
+  size_t GetOrgCnt() const { return header.org_cnt; }
+  size_t GetAxisCnt() const { return header.axis_cnt; }
+  const std::string & GetAxisName(size_t i) const { return axis_names[i]; }
+  size_t GetAxisSize(size_t i) const { return axis_sizes[i]; }
+  size_t GetInstLibSize() const { return inst_names.size(); }
+  const std::string & GetInstName(size_t id) const { return inst_names[id]; }
+  size_t GetInstArgCnt(size_t id) const { return inst_arg_cnts[id]; }
+  uint32_t GetInstFlags(size_t id) const { return (uint32_t)inst_flags[id]; }
+
+  bool IsOccupied(size_t cell) const { return GetCellOffset(cell) != 0; }
+
+  OrgView GetOrg(size_t cell) const {
+    emp_assert(IsOccupied(cell), cell);
+    return OrgView{base + GetCellOffset(cell), header.axis_cnt, (header.tag_width + 31) / 32, header.arg_cnt};
+  }
+
+  /// Map snapshot file at fpath. Returns false (and stays closed) if file is missing or malformed.
+  bool Open(const std::string & fpath) {
+    Close();
+    #ifndef EMSCRIPTEN
+    int fd = ::open(fpath.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PopSnapshotHeader)) { ::close(fd); return false; }
+    void * mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    base = (const unsigned char *)mapped;
+    size = (size_t)st.st_size;
+    if (!ParseMeta()) { Close(); return false; }
+    return true;
+    #else
+    return false;
+    #endif
+  }
+
+  void Close() {
+    #ifndef EMSCRIPTEN
+    if (base) munmap((void *)base, size);
+    #endif
+    base = nullptr;
+    size = 0;
+    cell_index = nullptr;
+    axis_names.clear(); axis_sizes.clear();
+    inst_names.clear(); inst_arg_cnts.clear(); inst_flags.clear();
+  }
+
+protected:
+  uint64_t GetCellOffset(size_t cell) const {
+    emp_assert(cell < header.cell_cnt, cell);
+    return Get<uint64_t>(cell_index + 8*cell);
+  }
+
+  bool ParseMeta() {
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, POP_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) return false;
+    if (header.version != POP_SNAPSHOT_VERSION) return false;
+    const size_t index_start = sizeof(PopSnapshotHeader) + header.meta_bytes;
+    if (index_start + 8 * header.cell_cnt > size) return false;
+    const unsigned char * ptr = base + sizeof(PopSnapshotHeader);
+    const unsigned char * meta_end = base + index_start;
+    auto read_name = [&ptr, meta_end](emp::vector<std::string> & names) {
+      if (ptr + 4 > meta_end) return false;
+      const uint32_t len = Get<uint32_t>(ptr);
+      if (ptr + 4 + len > meta_end) return false;
+      names.emplace_back((const char *)ptr + 4, len);
+      ptr += 4 + ((len + 3) / 4) * 4;
+      return true;
+    };
+    for (size_t i = 0; i < header.axis_cnt; ++i) {
+      if (ptr + 4 > meta_end) return false;
+      axis_sizes.emplace_back(Get<uint32_t>(ptr));
+      ptr += 4;
+      if (!read_name(axis_names)) return false;
+    }
+    for (size_t i = 0; i < header.inst_lib_cnt; ++i) {
+      if (ptr + 8 > meta_end) return false;
+      inst_arg_cnts.emplace_back(Get<uint32_t>(ptr));
+      inst_flags.emplace_back(Get<uint32_t>(ptr + 4));
+      ptr += 8;
+      if (!read_name(inst_names)) return false;
+    }
+    cell_index = base + index_start;
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MAPEGP_PROGRAM_MUTATOR_H
+#define MAPEGP_PROGRAM_MUTATOR_H
+
+#include <algorithm>
+
+#include "base/vector.h"
+#include "hardware/EventDrivenGP.h"
+#include "hardware/signalgp_utils.h"
+#include "tools/Random.h"
+
+#include "InstHistogram.h"
+
+/// emp::SignalGPMutator (same operators, settings, and random draws) that also keeps an instruction histogram up to
+/// date, so an organism's instruction count and entropy don't need a pass over the program after every mutation.
+///  - The program's functions are copied going in; afterwards, only functions whose instructions (by ID) changed
+///    get recounted.
+template <size_t TAG_WIDTH>
+class ProgramMutator : public emp::SignalGPMutator<TAG_WIDTH> {
+public:
+  using base_t = emp::SignalGPMutator<TAG_WIDTH>;
+  using hardware_t = emp::EventDrivenGP_AW<TAG_WIDTH>;
+  using program_t = typename hardware_t::Program;
+  using function_t = typename hardware_t::Function;
+
+protected:
+  emp::vector<function_t> prev_funcs;  ///< Program's functions before the current round of mutations.
+
+  /// Do a and b have the same instructions (by ID, in the same order)?
+  static bool SameInstIDs(const function_t & a, const function_t & b) {
+    if (a.GetSize() != b.GetSize()) return false;
+    for (size_t i = 0; i < a.GetSize(); ++i) if (a[i].id != b[i].id) return false;
+    return true;
+  }
+
+public:
+  ProgramMutator() : base_t(), prev_funcs() { ; }
+
+  using base_t::ApplyMutations;
+
+  /// Apply mutations to program (exactly as emp::SignalGPMutator would), keeping hist (if given; it must match
+  /// program going in) up to date. Returns the number of mutations.
+  size_t ApplyMutations(program_t & program, emp::Random & rnd, InstHistogram * hist) {
+    if (!hist) return base_t::ApplyMutations(program, rnd);
+    prev_funcs = program.program;
+    const size_t mut_cnt = base_t::ApplyMutations(program, rnd);
+    if (!mut_cnt) return 0;
+    const size_t shared_cnt = std::min(prev_funcs.size(), program.GetSize());
+    for (size_t fID = 0; fID < shared_cnt; ++fID) {
+      if (SameInstIDs(prev_funcs[fID], program[fID])) continue;
+      hist->RemoveFunction(prev_funcs[fID]);
+      hist->AddFunction(program[fID]);
+    }
+    for (size_t fID = shared_cnt; fID < prev_funcs.size(); ++fID) hist->RemoveFunction(prev_funcs[fID]);
+    for (size_t fID = shared_cnt; fID < program.GetSize(); ++fID) hist->AddFunction(program[fID]);
+    return mut_cnt;
+  }
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef MAPEGP_RANDOM_STREAMS_H
+#define MAPEGP_RANDOM_STREAMS_H
+
+#include <climits>
+#include <cstdint>
+#include <initializer_list>
+
+/// Counter-based seeding for independent random number streams.
+///  - A stream is named by a base seed plus a tuple of counters (e.g., update, organism position, trial).
+///  - The same name always maps to the same seed, no matter which thread asks or in what order.
+///  - Keys are mixed with the SplitMix64 finalizer, so neighboring counters give unrelated seeds.
+
+/// SplitMix64 finalizer.
+inline uint64_t MixStreamKey(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+/// Derive a seed for the random number stream named by (base_seed, keys...).
+/// Returned seed is always positive (emp::Random treats non-positive seeds as 'seed from the clock').
+inline int DeriveStreamSeed(uint64_t base_seed, std::initializer_list<uint64_t> keys) {
+  uint64_t h = MixStreamKey(base_seed);
+  for (uint64_t key : keys) h = MixStreamKey(h ^ MixStreamKey(key));
+  return (int)(h % (uint64_t)INT_MAX) + 1;
+}
+
+#endif
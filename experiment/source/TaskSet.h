@@ -6,7 +6,7 @@
 #include <algorithm>
 #include <functional>
 #include <map>
-#include <unordered_set>
+#include <cstdint>
 
 #include "base/Ptr.h"
 #include "base/vector.h"
@@ -21,6 +21,8 @@
 
 /// Task library for logic9 changing environment experiments.
 ///  - A library of tasks with common input/output types.
+///  - Submissions are looked up in a small open-addressing hash (output value => bitmask of tasks it solves),
+///    rebuilt whenever inputs change; Submit does no allocation (unless time stamp logging is turned on).
 template<typename INPUT_T, typename OUTPUT_T>
 class TaskSet {
 public:
@@ -29,27 +31,57 @@ public:
   using task_input_t = INPUT_T;
   using task_output_t = OUTPUT_T;
   using gen_sol_fun_t = std::function<void(Task &, const task_input_t &)>;
+  using task_mask_t = uint64_t;
+
+  static constexpr size_t MAX_TASKS = 64;   ///< Tasks that can share a solution are tracked as bits in a task_mask_t.
 
   struct Task {
     std::string name;
     size_t id;
     std::string desc;
     emp::vector<task_output_t> solutions;
-    emp::vector<size_t> completed_time_stamps;
-    emp::vector<size_t> credited_time_stamps;
+    size_t completed_cnt;
+    size_t credited_cnt;
+    size_t first_completed_time;
+    size_t last_completed_time;
+    size_t first_credited_time;
+    size_t last_credited_time;
+    emp::vector<size_t> completed_time_stamps;  ///< Only filled in if time stamp logging is on.
+    emp::vector<size_t> credited_time_stamps;   ///< Only filled in if time stamp logging is on.
     size_t wasted_completions; ///< Completions *before* receiving credit.
     gen_sol_fun_t generate_solutions;
 
     Task(const std::string & _n, size_t _i, gen_sol_fun_t _gen_sols, const std::string & _d)
-      : name(_n), id(_i), desc(_d), wasted_completions(0), generate_solutions(_gen_sols)
+      : name(_n), id(_i), desc(_d), completed_cnt(0), credited_cnt(0),
+        first_completed_time(0), last_completed_time(0), first_credited_time(0), last_credited_time(0),
+        wasted_completions(0), generate_solutions(_gen_sols)
     { ; }
 
-    size_t GetCompletionCnt() const { return completed_time_stamps.size(); }
-    size_t GetCreditedCnt() const { return credited_time_stamps.size(); }
+    size_t GetCompletionCnt() const { return completed_cnt; }
+    size_t GetCreditedCnt() const { return credited_cnt; }
     size_t GetWastedCompletionsCnt() const { return wasted_completions; }
+    size_t GetFirstCompletedTime() const { return first_completed_time; }
+    size_t GetLastCompletedTime() const { return last_completed_time; }
+    size_t GetFirstCreditedTime() const { return first_credited_time; }
+    size_t GetLastCreditedTime() const { return last_credited_time; }
+
+    void Reset() {
+      completed_cnt = 0;
+      credited_cnt = 0;
+      first_completed_time = last_completed_time = 0;
+      first_credited_time = last_credited_time = 0;
+      completed_time_stamps.resize(0);
+      credited_time_stamps.resize(0);
+      wasted_completions = 0;
+    }
   };
 
 protected:
+  /// Slot in solution hash; empty slots have no tasks.
+  struct SolutionSlot {
+    task_output_t output;
+    task_mask_t tasks;
+  };
 
   emp::vector<Task> task_lib;
   std::map<std::string, size_t> name_map;
@@ -62,12 +94,77 @@ protected:
   size_t time_all_tasks_completed;
   bool all_tasks_credited;
   bool all_tasks_completed;
+  bool log_time_stamps;             ///< Keep full completed/credited time stamp logs for each task?
   // task_input_t task_inputs;
 
   bool sollision;
-  std::unordered_set<task_output_t> solution_set; ///< Used for detecting collisions between solutions.
+  emp::vector<SolutionSlot> solution_table; ///< Open-addressing hash (size is a power of 2) of current solutions.
+
+  static size_t HashOutput(const task_output_t & out) {
+    // Fibonacci hashing: mix into the high bits and take them (std::hash is the identity for integers).
+    return (size_t)(((uint64_t)std::hash<task_output_t>()(out) * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+
+  /// Which tasks does sol solve? (0 if none)
+  task_mask_t FindTasks(const task_output_t & sol) const {
+    const size_t mask = solution_table.size() - 1;
+    for (size_t i = HashOutput(sol) & mask; solution_table[i].tasks; i = (i + 1) & mask) {
+      if (solution_table[i].output == sol) return solution_table[i].tasks;
+    }
+    return 0;
+  }
+
+  /// Add sol as a solution to task_id. Returns false if sol was already a solution (to any task).
+  bool AddSolution(const task_output_t & sol, size_t task_id) {
+    const size_t mask = solution_table.size() - 1;
+    size_t i = HashOutput(sol) & mask;
+    for ( ; solution_table[i].tasks; i = (i + 1) & mask) {
+      if (solution_table[i].output == sol) {
+        solution_table[i].tasks |= ((task_mask_t)1 << task_id);
+        return false;
+      }
+    }
+    solution_table[i].output = sol;
+    solution_table[i].tasks = ((task_mask_t)1 << task_id);
+    return true;
+  }
+
+  /// Record completion (and maybe credit) of task at timestamp.
+  void Complete(Task & task, size_t timestamp, bool credit) {
+    if (!task.completed_cnt) { task.first_completed_time = timestamp; unique_tasks_completed++; }
+    task.completed_cnt++;
+    task.last_completed_time = timestamp;
+    if (log_time_stamps) task.completed_time_stamps.emplace_back(timestamp);
+    total_tasks_completed++;
+    if (credit) {
+      if (!task.credited_cnt) { task.first_credited_time = timestamp; unique_tasks_credited++; }
+      task.credited_cnt++;
+      task.last_credited_time = timestamp;
+      if (log_time_stamps) task.credited_time_stamps.emplace_back(timestamp);
+      total_tasks_credited++;
+    } else if (!task.credited_cnt) {
+      // If you did it, but didn't get credit, increment wasted completions (total and task)
+      task.wasted_completions++;
+      total_tasks_wasted++;
+    }
+  }
 
 public:
+  /// Pool of inputs known to be collision-free, with each one's solutions (and solution hash) prebuilt.
+  ///  - Filled once (FillInputPool); switching a task set to pooled inputs (SetPooledInputs) is then just a copy.
+  ///  - Read-only once filled, so it can be shared by any number of task sets (with the same tasks).
+  struct InputPool {
+    emp::vector<task_input_t> inputs;
+    emp::vector<task_output_t> solutions;   ///< Solutions for each input (task order), sol_cnt per input.
+    emp::vector<SolutionSlot> tables;       ///< Solution hash for each input, table_size per input.
+    emp::vector<size_t> task_sol_cnts;      ///< Number of solutions for each task.
+    size_t sol_cnt = 0;
+    size_t table_size = 0;
+
+    size_t GetSize() const { return inputs.size(); }
+    const task_input_t & GetInputs(size_t id) const { return inputs[id]; }
+  };
+
   TaskSet()
     : unique_tasks_credited(0),
       unique_tasks_completed(0),
@@ -78,7 +175,9 @@ public:
       time_all_tasks_completed(0),
       all_tasks_credited(false),
       all_tasks_completed(false),
-      sollision(false)
+      log_time_stamps(false),
+      sollision(false),
+      solution_table(1, SolutionSlot{task_output_t(), 0})
     { ; }
   ~TaskSet() { ; }
 
@@ -102,6 +201,10 @@ public:
   size_t GetAllTasksCreditedTime() const { return time_all_tasks_credited; }
   bool AllTasksCredited() const { return all_tasks_credited; }
   bool AllTasksCompleted() const { return all_tasks_completed; }
+  bool GetLogTimeStamps() const { return log_time_stamps; }
+
+  /// Keep a full log of completed/credited time stamps for every task? (Off by default; allocates in Submit.)
+  void SetLogTimeStamps(bool log) { log_time_stamps = log; }
 
   bool IsTask(const std::string name) const { return emp::Has(name_map, name); }
 
@@ -110,6 +213,7 @@ public:
                const std::string & desc = "")
   {
     const size_t id = task_lib.size();
+    emp_assert(id < MAX_TASKS, "Too many tasks for task mask.", name);
     task_lib.emplace_back(name, id, gen_sols, desc);
     name_map[name] = id;
   }
@@ -125,11 +229,7 @@ public:
     time_all_tasks_completed = 0;
     all_tasks_credited = false;
     all_tasks_completed = false;
-    for (size_t i = 0; i < task_lib.size(); ++i) {
-      task_lib[i].completed_time_stamps.resize(0);
-      task_lib[i].credited_time_stamps.resize(0);
-      task_lib[i].wasted_completions = 0;
-    }
+    for (size_t i = 0; i < task_lib.size(); ++i) task_lib[i].Reset();
   }
 
   bool IsCollision() const { return sollision; }
@@ -138,45 +238,82 @@ public:
   /// Set inputs. Reset everything.
   void SetInputs(const task_input_t & inputs) {
     sollision = false;
-    solution_set.clear();
     Reset();
+    size_t sol_cnt = 0;
     for (size_t i = 0; i < task_lib.size(); ++i) {
       task_lib[i].solutions.resize(0);
       task_lib[i].generate_solutions(task_lib[i], inputs);
+      sol_cnt += task_lib[i].solutions.size();
+    }
+    // Keep table at most half full (sized once; solution counts don't change between inputs).
+    size_t table_size = 8;
+    while (table_size < 2 * sol_cnt) table_size <<= 1;
+    if (solution_table.size() != table_size) solution_table.resize(table_size);
+    for (SolutionSlot & slot : solution_table) slot.tasks = 0;
+    for (size_t i = 0; i < task_lib.size(); ++i) {
       for (size_t s = 0; s < task_lib[i].solutions.size(); ++s) {
-        if (emp::Has(solution_set, task_lib[i].solutions[s])) {
-          sollision = true;
-        } else {
-          solution_set.emplace(task_lib[i].solutions[s]);
-        }
+        if (!AddSolution(task_lib[i].solutions[s], i)) sollision = true;
       }
     }
   }
 
+  /// Fill pool with cnt collision-free inputs drawn from gen_inputs (redrawing on collision).
+  /// Leaves this task set reset on the last pooled input.
+  void FillInputPool(InputPool & pool, size_t cnt, const std::function<task_input_t()> & gen_inputs) {
+    pool.inputs.clear();
+    pool.solutions.clear();
+    pool.tables.clear();
+    pool.task_sol_cnts.clear();
+    pool.sol_cnt = 0;
+    pool.table_size = 0;
+    for (size_t k = 0; k < cnt; ++k) {
+      task_input_t inputs = gen_inputs();
+      SetInputs(inputs);
+      while (IsCollision()) {
+        inputs = gen_inputs();
+        SetInputs(inputs);
+      }
+      if (k == 0) {
+        for (size_t i = 0; i < task_lib.size(); ++i) pool.task_sol_cnts.emplace_back(task_lib[i].solutions.size());
+        for (size_t i = 0; i < task_lib.size(); ++i) pool.sol_cnt += task_lib[i].solutions.size();
+        pool.table_size = solution_table.size();
+      }
+      pool.inputs.emplace_back(inputs);
+      for (size_t i = 0; i < task_lib.size(); ++i) {
+        emp_assert(task_lib[i].solutions.size() == pool.task_sol_cnts[i], "Pooled inputs need a fixed number of solutions per task.");
+        pool.solutions.insert(pool.solutions.end(), task_lib[i].solutions.begin(), task_lib[i].solutions.end());
+      }
+      pool.tables.insert(pool.tables.end(), solution_table.begin(), solution_table.end());
+    }
+  }
+
+  /// Cheaper SetInputs: switch to input id from pool (which must have been filled by a task set with the same tasks).
+  /// Reuses solution storage; no solution generation, collision checking, or (after the first call) allocation.
+  void SetPooledInputs(const InputPool & pool, size_t id) {
+    emp_assert(id < pool.GetSize(), id, pool.GetSize());
+    emp_assert(pool.task_sol_cnts.size() == task_lib.size());
+    sollision = false;
+    Reset();
+    const task_output_t * sols = pool.solutions.data() + id * pool.sol_cnt;
+    for (size_t i = 0; i < task_lib.size(); ++i) {
+      task_lib[i].solutions.assign(sols, sols + pool.task_sol_cnts[i]);
+      sols += pool.task_sol_cnts[i];
+    }
+    if (solution_table.size() != pool.table_size) solution_table.resize(pool.table_size);
+    std::copy(pool.tables.begin() + id * pool.table_size, pool.tables.begin() + (id + 1) * pool.table_size,
+              solution_table.begin());
+  }
+
   /// Submit possible solution, checking against all tasks.
   /// If submission is indeed a solution, record information about task completion.
   /// Return whether or not submitted solution was a solution.
+  /// NOTE: A task is completed at most once per submission (even if sol matches more than one of its
+  ///       solutions; that's a collision anyway).
   bool Submit(const task_output_t & sol, size_t timestamp=0, bool credit=true) {
-    bool success = false;
-    for (size_t i = 0; i < task_lib.size(); ++i) {
-      Task & task = task_lib[i];
-      for (size_t s = 0; s < task.solutions.size(); ++s) {
-        if (task.solutions[s] == sol) {
-          success = true;
-          task.completed_time_stamps.emplace_back(timestamp);
-          if (task.GetCompletionCnt() == 1) unique_tasks_completed++;
-          total_tasks_completed++;
-          if (credit) {
-            task.credited_time_stamps.emplace_back(timestamp);
-            if (task.GetCreditedCnt() == 1) unique_tasks_credited++;
-            total_tasks_credited++;
-          } else if (!task.GetCreditedCnt()) {
-            // If you did it, but didn't get credit, increment wasted completions (total and task)
-            task.wasted_completions++;
-            total_tasks_wasted++;
-          }
-        }
-      }
+    task_mask_t tasks = FindTasks(sol);
+    const bool success = (tasks != 0);
+    for (size_t i = 0; tasks; ++i, tasks >>= 1) {
+      if (tasks & 1) Complete(task_lib[i], timestamp, credit);
     }
     if (!all_tasks_credited && unique_tasks_credited == GetSize()) {
       time_all_tasks_credited = timestamp;
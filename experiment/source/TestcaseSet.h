@@ -9,6 +9,21 @@
 #include <fstream>
 #include <set>
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#ifndef EMSCRIPTEN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "base/array.h"
 #include "base/vector.h"
@@ -16,69 +31,348 @@
 #include "tools/Random.h"
 #include "tools/random_utils.h"
 
+/// Binary testcase cache (TESTCASES_FPATH + ".bin") format, all native-endian:
+///  - Header: magic, version, sizeof(input), sizeof(output), input/output are floating point, has output,
+///    source file size, source file mtime, testcase count, input arena length.
+///  - Then: input offsets (testcase count + 1, uint64), input arena, outputs.
+///  - A cache is only used if its header matches the source file (size + mtime) and the set's types.
+constexpr char TESTCASE_CACHE_MAGIC[8] = {'M','A','P','E','T','C','S','B'};
+constexpr uint32_t TESTCASE_CACHE_VERSION = 1;
+
+/// Set of testcases (inputs + expected output), stored flat:
+///  - All inputs live in one contiguous arena; each testcase's inputs are a [begin, end) slice of it.
+///  - Accessors hand out views/references into storage (never copies), so they're cheap on the evaluation path.
+///  - CSV files are parsed in place (mmap) with typed number parsing. Rows may have different numbers of columns
+///    (variable-length inputs); the last column is the output. Lines where no field is a number (the header, and
+///    labels between sections, e.g. count-odds.csv's train/test split) are skipped.
 template <typename INPUT_TYPE, typename OUTPUT_TYPE>
 class TestcaseSet {
-protected:
-    using input_t = emp::vector<INPUT_TYPE>;
+public:
     using output_t = OUTPUT_TYPE;
-    using test_case_t = std::pair<input_t, output_t>;
-    emp::vector<test_case_t> test_cases;
+
+    /// Read-only view of a single testcase's inputs (span-style; valid until the set is modified).
+    class InputView {
+    protected:
+        const INPUT_TYPE * ptr;
+        size_t cnt;
+
+    public:
+        InputView(const INPUT_TYPE * _ptr, size_t _cnt) : ptr(_ptr), cnt(_cnt) { ; }
+
+        size_t size() const { return cnt; }
+        bool empty() const { return cnt == 0; }
+        const INPUT_TYPE * data() const { return ptr; }
+        const INPUT_TYPE * begin() const { return ptr; }
+        const INPUT_TYPE * end() const { return ptr + cnt; }
+        const INPUT_TYPE & operator[](size_t i) const {
+            emp_assert(i < cnt, i, cnt);
+            return ptr[i];
+        }
+    };
+
+    /// A single testcase, viewed in place.
+    struct Testcase {
+        InputView inputs;
+        const output_t & output;
+    };
+
+protected:
+    emp::vector<INPUT_TYPE> input_arena;    ///< Inputs for every testcase, back to back.
+    emp::vector<size_t> input_offsets;      ///< Testcase i's inputs are input_arena[input_offsets[i], input_offsets[i+1]).
+    emp::vector<output_t> outputs;
 
 public:
-    TestcaseSet(std::string filename) {
+    TestcaseSet(std::string filename) : input_arena(), input_offsets(1, 0), outputs() {
         LoadTestcases(filename);
     }
 
-    TestcaseSet() {}
+    TestcaseSet() : input_arena(), input_offsets(1, 0), outputs() {}
 
-    input_t & GetInput(size_t id) { 
-        emp_assert(id < test_cases.size());
-        return test_cases[id].first; 
-    }
+    size_t GetSize() const { return outputs.size(); }
 
-    output_t & GetOutput(size_t id) {
-        emp_assert(id < test_cases.size());
-        return test_cases[id].second;
+    InputView GetInput(size_t id) const { 
+        emp_assert(id < outputs.size());
+        return InputView(input_arena.data() + input_offsets[id], input_offsets[id+1] - input_offsets[id]);
     }
 
-    emp::vector<std::pair<input_t, output_t> > & GetTestcases() {
-        return test_cases;
+    const output_t & GetOutput(size_t id) const {
+        emp_assert(id < outputs.size());
+        return outputs[id];
     }
 
     emp::vector<size_t> GetSubset(int trials, emp::Random * random) {
-        return emp::Choose(*random, test_cases.size(), trials);
+        return emp::Choose(*random, outputs.size(), trials);
     }
 
-    std::pair<input_t, output_t> operator[](size_t i) {
-        return test_cases[i];
+    Testcase operator[](size_t i) const {
+        return Testcase{GetInput(i), GetOutput(i)};
     }
 
-    void LoadTestcases(std::string filename, bool contains_output = true) {
-        std::ifstream infile(filename);
-        std::string line;
+    /// Add a testcase (copying inputs into the arena).
+    void AddTestcase(const emp::vector<INPUT_TYPE> & inputs, const output_t & output) {
+        input_arena.insert(input_arena.end(), inputs.begin(), inputs.end());
+        input_offsets.emplace_back(input_arena.size());
+        outputs.emplace_back(output);
+    }
+
+    void Clear() {
+        input_arena.clear();
+        input_offsets.resize(1);
+        outputs.clear();
+    }
 
-        if (!infile.is_open()){
+    /// Load testcases from CSV file (header line, then one testcase per line: inputs..., output).
+    /// If use_cache, try filename + ".bin" first, and (re)write it after parsing if it's missing or stale.
+    /// Malformed files (bad or out of range numbers) are reported and end the run.
+    void LoadTestcases(std::string filename, bool contains_output = true, bool use_cache = false) {
+        Clear();
+        const std::string cache_fpath = filename + ".bin";
+        uint64_t src_size = 0;
+        int64_t src_mtime = 0;
+        if (!GetFileStamp(filename, src_size, src_mtime)) {
             std::cout << "ERROR: " << filename << " did not open correctly" << std::endl;
             return;
         }
+        if (use_cache && LoadCache(cache_fpath, contains_output, src_size, src_mtime)) return;
+        Clear();
+        if (!ParseCSV(filename, contains_output)) {
+            std::cout << "ERROR: " << filename << " did not open correctly" << std::endl;
+            return;
+        }
+        if (use_cache && !SaveCache(cache_fpath, contains_output, src_size, src_mtime)) {
+            std::cout << "WARNING: failed to write testcase cache (" << cache_fpath << ")." << std::endl;
+        }
+    }
+
+protected:
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t input_size;
+        uint32_t output_size;
+        uint8_t input_float;
+        uint8_t output_float;
+        uint8_t has_output;
+        uint8_t pad;
+        uint64_t src_size;
+        int64_t src_mtime;
+        uint64_t testcase_cnt;
+        uint64_t arena_len;
+    };
+
+    static bool GetFileStamp(const std::string & fpath, uint64_t & fsize, int64_t & mtime) {
+        #ifndef EMSCRIPTEN
+        struct stat st;
+        if (stat(fpath.c_str(), &st) != 0) return false;
+        fsize = (uint64_t)st.st_size;
+        mtime = (int64_t)st.st_mtime;
+        return true;
+        #else
+        std::ifstream ifs(fpath, std::ios::binary | std::ios::ate);
+        if (!ifs.is_open()) return false;
+        fsize = (uint64_t)ifs.tellg();
+        mtime = 0;
+        return true;
+        #endif
+    }
+
+    CacheHeader MakeCacheHeader(bool contains_output, uint64_t src_size, int64_t src_mtime) const {
+        CacheHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, TESTCASE_CACHE_MAGIC, sizeof(header.magic));
+        header.version = TESTCASE_CACHE_VERSION;
+        header.input_size = (uint32_t)sizeof(INPUT_TYPE);
+        header.output_size = (uint32_t)sizeof(output_t);
+        header.input_float = (uint8_t)std::is_floating_point<INPUT_TYPE>::value;
+        header.output_float = (uint8_t)std::is_floating_point<output_t>::value;
+        header.has_output = (uint8_t)contains_output;
+        header.src_size = src_size;
+        header.src_mtime = src_mtime;
+        header.testcase_cnt = outputs.size();
+        header.arena_len = input_arena.size();
+        return header;
+    }
+
+    /// Load from binary cache; returns false if cache is missing, stale, or malformed.
+    bool LoadCache(const std::string & fpath, bool contains_output, uint64_t src_size, int64_t src_mtime) {
+        std::ifstream ifs(fpath, std::ios::binary);
+        if (!ifs.is_open()) return false;
+        CacheHeader header;
+        if (!ifs.read((char *)&header, sizeof(header))) return false;
+        CacheHeader expected = MakeCacheHeader(contains_output, src_size, src_mtime);
+        expected.testcase_cnt = header.testcase_cnt;
+        expected.arena_len = header.arena_len;
+        if (std::memcmp(&header, &expected, sizeof(header)) != 0) return false;
+        emp::vector<uint64_t> offsets(header.testcase_cnt + 1);
+        input_arena.resize(header.arena_len);
+        outputs.resize(header.testcase_cnt);
+        if (!ifs.read((char *)offsets.data(), (std::streamsize)(offsets.size() * sizeof(uint64_t)))) return false;
+        if (header.arena_len && !ifs.read((char *)input_arena.data(), (std::streamsize)(input_arena.size() * sizeof(INPUT_TYPE)))) return false;
+        if (header.testcase_cnt && !ifs.read((char *)outputs.data(), (std::streamsize)(outputs.size() * sizeof(output_t)))) return false;
+        input_offsets.resize(offsets.size());
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            if (offsets[i] > header.arena_len || (i && offsets[i] < offsets[i-1])) return false;
+            input_offsets[i] = (size_t)offsets[i];
+        }
+        return input_offsets[0] == 0 && input_offsets.back() == input_arena.size();
+    }
 
-        // Ignore header
-        getline(infile, line);
+    /// Write binary cache (to a temporary file, then renamed into place so concurrent jobs never see half a cache).
+    bool SaveCache(const std::string & fpath, bool contains_output, uint64_t src_size, int64_t src_mtime) const {
+        #ifndef EMSCRIPTEN
+        const std::string tmp_fpath = fpath + ".tmp" + std::to_string((long long)getpid());
+        #else
+        const std::string tmp_fpath = fpath + ".tmp";
+        #endif
+        std::ofstream ofs(tmp_fpath, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) return false;
+        const CacheHeader header = MakeCacheHeader(contains_output, src_size, src_mtime);
+        ofs.write((const char *)&header, sizeof(header));
+        for (size_t offset : input_offsets) {
+            const uint64_t val = offset;
+            ofs.write((const char *)&val, sizeof(val));
+        }
+        ofs.write((const char *)input_arena.data(), (std::streamsize)(input_arena.size() * sizeof(INPUT_TYPE)));
+        ofs.write((const char *)outputs.data(), (std::streamsize)(outputs.size() * sizeof(output_t)));
+        ofs.close();
+        if (!ofs) { std::remove(tmp_fpath.c_str()); return false; }
+        return std::rename(tmp_fpath.c_str(), fpath.c_str()) == 0;
+    }
 
-        while ( getline (infile,line)) {
-            emp::vector<std::string> split_line = emp::slice(line, ',');
-            input_t test_case;
-            for (size_t i = 0; i < (split_line.size() - (size_t)contains_output); i++) {
-                test_case.push_back(std::atoi(split_line[i].c_str()));
+    /// Parse number in [begin, end) (surrounding spaces allowed) into val. Returns false if it isn't one (or, for
+    /// integers, if it doesn't fit in T).
+    template <typename T>
+    static bool ParseField(const char * begin, const char * end, T & val) {
+        while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+        if (begin == end) return false;
+        if (std::is_integral<T>::value) {
+            bool neg = false;
+            if (*begin == '-' || *begin == '+') { neg = (*begin == '-'); ++begin; }
+            if (begin == end) return false;
+            // Largest magnitude T can hold with this sign (int_t only exists so this compiles for floating point T).
+            using int_t = typename std::conditional<std::is_integral<T>::value, T, long long>::type;
+            const unsigned long long max_val = (unsigned long long)std::numeric_limits<int_t>::max();
+            const unsigned long long limit = neg ? (std::is_signed<int_t>::value ? max_val + 1 : 0) : max_val;
+            unsigned long long result = 0;
+            for ( ; begin < end; ++begin) {
+                if (*begin < '0' || *begin > '9') return false;
+                const unsigned long long digit = (unsigned long long)(*begin - '0');
+                if (result > limit / 10 || (result == limit / 10 && digit > limit % 10)) return false;
+                result = result * 10 + digit;
             }
-            output_t answer;
-            if (contains_output) {
-                answer = std::atoi(split_line[split_line.size()-1].c_str());
+            val = (neg && result) ? (T)(-(long long)(result - 1) - 1) : (T)result;
+            return true;
+        }
+        // Floating point: strtod needs a terminated string, so copy the (short) field out first.
+        char buf[64];
+        const size_t len = (size_t)(end - begin);
+        if (len >= sizeof(buf)) return false;
+        std::memcpy(buf, begin, len);
+        buf[len] = '\0';
+        char * parse_end = nullptr;
+        const double result = std::strtod(buf, &parse_end);
+        if (parse_end != buf + len) return false;
+        val = (T)result;
+        return true;
+    }
+
+    /// What ParseField expects a T field to hold (for error messages).
+    template <typename T>
+    static const char * NumberName() {
+        return std::is_integral<T>::value ? "integer (or is out of range)" : "number";
+    }
+
+    /// Is the line in [begin, end) labels rather than a testcase (i.e., none of its fields are numbers)?
+    static bool IsLabelRow(const char * begin, const char * end) {
+        for (const char * field = begin; field <= end; ) {
+            const char * field_end = (const char *)std::memchr(field, ',', (size_t)(end - field));
+            if (!field_end) field_end = end;
+            double val;
+            if (ParseField(field, field_end, val)) return false;
+            field = field_end + 1;
+        }
+        return true;
+    }
+
+    /// Parse CSV text in [data, data + len) into this set. Bad rows end the run (with an error pointing at them).
+    void ParseText(const std::string & filename, const char * data, size_t len, bool contains_output) {
+        const char * const data_end = data + len;
+        const char * line = data;
+        size_t line_num = 0;
+        while (line < data_end) {
+            const char * line_end = (const char *)std::memchr(line, '\n', (size_t)(data_end - line));
+            if (!line_end) line_end = data_end;
+            const char * next_line = (line_end < data_end) ? line_end + 1 : data_end;
+            const char * content_end = (line_end > line && line_end[-1] == '\r') ? line_end - 1 : line_end;
+            ++line_num;
+            // Skip the header and blank lines.
+            if (line_num == 1 || content_end == line) { line = next_line; continue; }
+            // Count columns (rows can differ: everything but the output is input).
+            size_t cols = 1;
+            for (const char * c = line; c < content_end; ++c) cols += (*c == ',');
+            const size_t input_cnt = cols - (size_t)contains_output;
+            const char * field = line;
+            bool label_row = false;
+            for (size_t col = 0; col < cols; ++col) {
+                const char * field_end = (const char *)std::memchr(field, ',', (size_t)(content_end - field));
+                if (!field_end) field_end = content_end;
+                bool ok;
+                if (col < input_cnt) {
+                    INPUT_TYPE val = INPUT_TYPE();
+                    ok = ParseField(field, field_end, val);
+                    input_arena.emplace_back(val);
+                } else {
+                    output_t val = output_t();
+                    ok = ParseField(field, field_end, val);
+                    outputs.emplace_back(val);
+                }
+                if (!ok && IsLabelRow(line, content_end)) {
+                    // Not a testcase: drop whatever we parsed from it so far.
+                    input_arena.resize(input_offsets.back());
+                    outputs.resize(input_offsets.size() - 1);
+                    label_row = true;
+                    break;
+                }
+                if (!ok) {
+                    std::cout << "ERROR: " << filename << " line " << line_num << " column " << (col + 1)
+                              << " (" << std::string(field, field_end) << ") is not a valid "
+                              << (col < input_cnt ? NumberName<INPUT_TYPE>() : NumberName<output_t>())
+                              << ". Exiting..." << std::endl;
+                    exit(-1);
+                }
+                field = field_end + 1;
             }
-            test_cases.push_back(std::make_pair(test_case, answer));
-            // std::cout << emp::to_string(test_case) << " " << answer << std::endl;
+            line = next_line;
+            if (label_row) continue;
+            if (!contains_output) outputs.emplace_back(output_t());
+            input_offsets.emplace_back(input_arena.size());
         }
-        infile.close();
+    }
+
+    /// Map (or read) CSV file and parse it. Returns false if the file couldn't be read.
+    bool ParseCSV(const std::string & filename, bool contains_output) {
+        #ifndef EMSCRIPTEN
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        const size_t len = (size_t)st.st_size;
+        if (len == 0) { ::close(fd); return true; }
+        void * mapped = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        madvise(mapped, len, MADV_SEQUENTIAL);
+        ParseText(filename, (const char *)mapped, len, contains_output);
+        munmap(mapped, len);
+        return true;
+        #else
+        std::ifstream infile(filename, std::ios::binary);
+        if (!infile.is_open()) return false;
+        std::string text((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+        ParseText(filename, text.data(), text.size(), contains_output);
+        return true;
+        #endif
     }
 
 };
@@ -0,0 +1,142 @@
+#ifndef MAPEGP_WORKER_POOL_H
+#define MAPEGP_WORKER_POOL_H
+
+#include <functional>
+#include <atomic>
+
+#ifndef EMSCRIPTEN
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#include "base/vector.h"
+
+/// Utility class used to farm out independent jobs (e.g., organism evaluations) to a fixed pool of worker threads.
+///  - Worker 0 is always the calling thread; a pool of size 1 runs every job serially without spawning threads.
+///  - Jobs are handed out dynamically, so which worker runs which job depends on timing. Anything a job writes
+///    must either be keyed by job ID or be private to the worker running it.
+class WorkerPool {
+public:
+  using job_fun_t = std::function<void(size_t, size_t)>;  ///< fun(worker_id, job_id)
+
+protected:
+  size_t worker_cnt;  ///< Total number of workers (including calling thread).
+
+  #ifndef EMSCRIPTEN
+  emp::vector<std::thread> threads;
+  std::mutex mtx;
+  std::condition_variable start_cv;
+  std::condition_variable done_cv;
+
+  const job_fun_t * cur_fun;   ///< Job function for current batch.
+  size_t job_cnt;              ///< Number of jobs in current batch.
+  std::atomic<size_t> next_job;
+  size_t batch_id;             ///< Bumped every time a batch is started; wakes up sleeping workers.
+  size_t workers_done;         ///< How many spawned workers have finished the current batch?
+  bool stop;
+
+  /// Claim and run jobs from the current batch until there are none left.
+  void DoJobs(size_t worker_id) {
+    for (size_t job_id = next_job++; job_id < job_cnt; job_id = next_job++) {
+      (*cur_fun)(worker_id, job_id);
+    }
+  }
+
+  /// Run batches as they're started; seen_batch is the last batch started before this worker was spawned.
+  void WorkerLoop(size_t worker_id, size_t seen_batch) {
+    while (true) {
+      std::unique_lock<std::mutex> lock(mtx);
+      start_cv.wait(lock, [this, &seen_batch]() { return stop || batch_id != seen_batch; });
+      if (stop) return;
+      seen_batch = batch_id;
+      lock.unlock();
+      DoJobs(worker_id);
+      lock.lock();
+      ++workers_done;
+      if (workers_done + 1 == worker_cnt) done_cv.notify_one();
+    }
+  }
+
+  void StopThreads() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+    start_cv.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    threads.clear();
+    stop = false;
+  }
+  #endif
+
+public:
+  WorkerPool(size_t _worker_cnt=1)
+    : worker_cnt(0)
+    #ifndef EMSCRIPTEN
+    , threads(), mtx(), start_cv(), done_cv(),
+      cur_fun(nullptr), job_cnt(0), next_job(0), batch_id(0), workers_done(0), stop(false)
+    #endif
+  {
+    Resize(_worker_cnt);
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool & operator=(const WorkerPool &) = delete;
+
+  ~WorkerPool() {
+    #ifndef EMSCRIPTEN
+    StopThreads();
+    #endif
+  }
+
+  /// How many workers (including the calling thread) does this pool have?
+  size_t GetSize() const { return worker_cnt; }
+
+  /// Change the number of workers. Must not be called while a batch is running.
+  void Resize(size_t _worker_cnt) {
+    if (_worker_cnt < 1) _worker_cnt = 1;
+    #ifdef EMSCRIPTEN
+    worker_cnt = 1; // No threads on the web.
+    #else
+    StopThreads();
+    worker_cnt = _worker_cnt;
+    // New workers must only run batches started after now (not the last batch run, if there was one). Taken here
+    // rather than when a thread starts, so a Run that beats a new thread to the mutex can't be missed.
+    size_t cur_batch;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      cur_batch = batch_id;
+    }
+    for (size_t i = 1; i < worker_cnt; ++i) {
+      threads.emplace_back([this, i, cur_batch]() { WorkerLoop(i, cur_batch); });
+    }
+    #endif
+  }
+
+  /// Run fun(worker_id, job_id) for every job_id in [0, _job_cnt), returning once all jobs are finished.
+  void Run(size_t _job_cnt, const job_fun_t & fun) {
+    #ifndef EMSCRIPTEN
+    if (worker_cnt > 1 && _job_cnt > 1) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        cur_fun = &fun;
+        job_cnt = _job_cnt;
+        next_job = 0;
+        workers_done = 0;
+        ++batch_id;
+      }
+      start_cv.notify_all();
+      DoJobs(0);
+      std::unique_lock<std::mutex> lock(mtx);
+      done_cv.wait(lock, [this]() { return workers_done + 1 == worker_cnt; });
+      cur_fun = nullptr;
+      return;
+    }
+    #endif
+    for (size_t job_id = 0; job_id < _job_cnt; ++job_id) fun(0, job_id);
+  }
+
+};
+
+#endif
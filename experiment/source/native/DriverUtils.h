@@ -0,0 +1,59 @@
+#ifndef MAPEGP_DRIVER_UTILS_H
+#define MAPEGP_DRIVER_UTILS_H
+
+// Helpers shared by the native benchmark (MAPE_BENCH) and test (MAPE_TEST) drivers.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "base/vector.h"
+
+#include "../MapElitesGP_Config.h"
+
+/// Config settings that only last as long as this object (previous values are restored on destruction).
+class ConfigOverrides {
+protected:
+  MapElitesGPConfig & config;
+  emp::vector<std::pair<std::string, std::string>> saved;
+
+public:
+  ConfigOverrides(MapElitesGPConfig & _config) : config(_config), saved() { ; }
+  ~ConfigOverrides() {
+    for (size_t i = saved.size(); i > 0; --i) config.Set(saved[i-1].first, saved[i-1].second);
+  }
+
+  ConfigOverrides & Set(const std::string & name, const std::string & val) {
+    saved.emplace_back(name, config.Get(name));
+    config.Set(name, val);
+    return *this;
+  }
+};
+
+/// Make directory dir (if need be) and move into it.
+void EnterDir(const std::string & dir) {
+  mkdir(dir.c_str(), ACCESSPERMS);
+  if (chdir(dir.c_str()) != 0) {
+    std::cout << "Failed to enter directory (" << dir << "). Exiting..." << std::endl;
+    exit(-1);
+  }
+}
+
+std::string GetCwd() {
+  char buf[4096];
+  return (getcwd(buf, sizeof(buf))) ? std::string(buf) : std::string(".");
+}
+
+void CopyFile(const std::string & src, const std::string & dst) {
+  std::ifstream ifs(src, std::ios::binary);
+  std::ofstream ofs(dst, std::ios::binary | std::ios::trunc);
+  if (!ifs.is_open() || !ofs.is_open() || !(ofs << ifs.rdbuf())) {
+    std::cout << "Failed to copy " << src << " to " << dst << ". Exiting..." << std::endl;
+    exit(-1);
+  }
+}
+
+#endif
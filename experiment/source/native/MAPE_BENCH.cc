@@ -0,0 +1,438 @@
+// This is the main function for the NATIVE microbenchmark suite ('make bench').
+// Each benchmark times one piece of a run in isolation (hardware, evaluation, selection, snapshots, ...); results
+// are written as JSON (see Benchmark.h).
+//
+// Usage: ./MAPE_BENCH [--bench-out bench.json] [--bench-filter STR] [--bench-min-time SECS] [--bench-repeats N]
+//                     [--bench-config configs/MapElitesGPConfig.cfg] [--bench-testcases configs/testcases]
+//                     [--bench-scratch bench_scratch] [-CONFIG_SETTING VALUE ...]
+// Config settings start from the config file, then the benchmark defaults (see SetBenchDefaults), then the command
+// line. Benchmarks pick their own world structure, problem, and selection method.
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "base/vector.h"
+#include "config/command_line.h"
+#include "config/ArgManager.h"
+#include "tools/Random.h"
+#include "tools/random_utils.h"
+
+#include "../Benchmark.h"
+#include "DriverUtils.h"
+#include "../MapElitesSignalGP_World.h"
+#include "../MapElitesScopeGP_World.h"
+
+constexpr int BENCH_SEED = 1;
+constexpr size_t BENCH_NEVER = 1000000000;   ///< Data/snapshot interval that never comes up during benchmarks.
+constexpr size_t BENCH_FUNC_CNT = 8;         ///< Functions per instruction class benchmark program.
+constexpr size_t BENCH_FUNC_LEN = 64;        ///< Instructions per function in instruction class benchmark programs.
+constexpr size_t BENCH_MAPE_BATCH_SIZE = 64;
+
+/// Base instruction set, grouped into classes for the SignalGP instruction benchmarks.
+/// Anything else in a world's instruction set was added by its problem.
+const std::map<std::string, emp::vector<std::string>> INST_CLASSES = {
+  {"arithmetic", {"Inc", "Dec", "Not", "Add", "Sub", "Mult", "Div", "Mod"}},
+  {"comparison", {"TestEqu", "TestNEqu", "TestLess"}},
+  {"control", {"If", "While", "Countdown", "Close", "Break", "Call", "Return", "Fork", "Terminate", "Nop"}},
+  {"memory", {"SetMem", "CopyMem", "SwapMem", "Input", "Output", "Commit", "Pull"}}
+};
+
+/// Get (sorted) names of testcase (.csv) files in dir.
+emp::vector<std::string> ListTestcaseFiles(const std::string & dir) {
+  emp::vector<std::string> fnames;
+  DIR * dp = opendir(dir.c_str());
+  if (!dp) return fnames;
+  while (dirent * entry = readdir(dp)) {
+    const std::string fname(entry->d_name);
+    if (fname.size() > 4 && fname.compare(fname.size() - 4, 4, ".csv") == 0) fnames.emplace_back(fname);
+  }
+  closedir(dp);
+  std::sort(fnames.begin(), fnames.end());
+  return fnames;
+}
+
+/// Settings every benchmark starts from (before command line overrides): small, deterministic, and quiet (no
+/// periodic data files or snapshots, no checkpoints).
+void SetBenchDefaults(MapElitesGPConfig & config) {
+  config.RANDOM_SEED(BENCH_SEED);
+  config.POP_SIZE(100);
+  config.GENERATIONS(0);
+  config.POP_INIT_METHOD(0);
+  config.STATISTICS_INTERVAL(BENCH_NEVER);
+  config.SNAPSHOT_INTERVAL(BENCH_NEVER);
+  config.CHECKPOINT_INTERVAL(0);
+  config.RESUME(false);
+  config.DOM_SNAPSHOT_TRIAL_CNT(100);
+  config.MAP_SNAPSHOT_TRIAL_CNT(1);
+}
+
+/// SignalGP world with benchmarks for its insides.
+class SignalGPBenchWorld : public MapElitesSignalGPWorld {
+public:
+  SignalGPBenchWorld(emp::Random & rnd) : MapElitesSignalGPWorld(rnd) { ; }
+
+  /// Do everything Run does before its first update.
+  void Start() {
+    do_begin_run_sig.Trigger();
+    do_pop_init_sig.Trigger();
+  }
+
+  /// Evaluate the population (well-mixed worlds; MAP-Elites evaluates organisms as they're placed).
+  void EvaluateAll() { do_evaluation_sig.Trigger(); }
+
+  /// Time SingleProcess on programs built from a single class of instructions (see INST_CLASSES).
+  /// Programs are restarted (on a fresh main thread) whenever they run out of threads.
+  void BenchInstClasses(BenchmarkSuite & suite, const std::string & problem, bool base_classes) {
+    using function_t = typename hardware_t::Function;
+    std::map<std::string, emp::vector<size_t>> class_insts;
+    for (size_t id = 0; id < inst_lib.GetSize(); ++id) {
+      std::string inst_class = "problem/" + problem;
+      for (const auto & entry : INST_CLASSES) {
+        const emp::vector<std::string> & names = entry.second;
+        if (std::find(names.begin(), names.end(), inst_lib.GetName(id)) != names.end()) inst_class = entry.first;
+      }
+      if (base_classes || inst_class == "problem/" + problem) class_insts[inst_class].emplace_back(id);
+    }
+    eval_ctx_t & ctx = *eval_ctxs[0];
+    // Problem-specific instructions expect to run in the middle of an evaluation trial.
+    Evaluate(GetOrg(0), ctx);
+    ctx.trial_id = 0;
+    emp::Random rnd(BENCH_SEED);
+    const size_t func_cnt = emp::Min(BENCH_FUNC_CNT, PROG_MAX_FUNC_CNT);
+    for (const auto & entry : class_insts) {
+      const std::string name = "signalgp/inst/" + entry.first;
+      if (!suite.IsSelected(name)) continue;
+      const emp::vector<size_t> & insts = entry.second;
+      const emp::vector<tag_t> tags = emp::GenRandSignalGPTags<org_t::TAG_WIDTH>(rnd, func_cnt, true);
+      program_t prog(&inst_lib);
+      for (size_t fID = 0; fID < func_cnt; ++fID) {
+        prog.PushFunction(function_t(tags[fID]));
+        for (size_t i = 0; i < BENCH_FUNC_LEN; ++i) {
+          prog.PushInst(insts[rnd.GetUInt(insts.size())], rnd.GetInt(PROG_MIN_ARG_VAL, PROG_MAX_ARG_VAL+1),
+                        rnd.GetInt(PROG_MIN_ARG_VAL, PROG_MAX_ARG_VAL+1), rnd.GetInt(PROG_MIN_ARG_VAL, PROG_MAX_ARG_VAL+1),
+                        tags[rnd.GetUInt(func_cnt)]);
+        }
+      }
+      ctx.hw->SetProgram(prog);
+      ResetEvalHW(ctx);
+      suite.Run(name, [this, &ctx](size_t ops) {
+        for (size_t i = 0; i < ops; ++i) {
+          if (ctx.hw->GetActiveCores().empty() && ctx.hw->GetPendingCores().empty()) {
+            ResetEvalHW(ctx);
+            ctx.hw->SpawnCore(0, memory_t(), true);
+          }
+          ctx.hw->SingleProcess();
+        }
+      });
+    }
+  }
+
+  /// Time full evaluations (every trial) of population members, one per op.
+  void BenchEvaluate(BenchmarkSuite & suite, const std::string & name) {
+    eval_ctx_t & ctx = *eval_ctxs[0];
+    size_t next = 0;
+    suite.Run(name, [this, &ctx, &next](size_t ops) {
+      for (size_t i = 0; i < ops; ++i, next = (next + 1) % GetSize()) Evaluate(GetOrg(next), ctx);
+    });
+  }
+
+  void BenchCalcGenomeInfo(BenchmarkSuite & suite, const std::string & name) {
+    size_t next = 0;
+    suite.Run(name, [this, &next](size_t ops) {
+      for (size_t i = 0; i < ops; ++i, next = (next + 1) % GetSize()) GetOrg(next).CalcGenomeInfo();
+    });
+  }
+
+  /// Time TaskSet::Submit on a mix of solutions (to some task) and random outputs (almost surely not solutions).
+  /// Tasks get reset after every pass through the outputs (so solutions keep completing tasks).
+  void BenchTaskSubmit(BenchmarkSuite & suite, const std::string & name) {
+    eval_ctx_t & ctx = *eval_ctxs[0];
+    ResetTasks(ctx);
+    taskset_t & tasks = ctx.task_set;
+    emp::Random rnd(BENCH_SEED);
+    emp::vector<task_io_t> outputs;
+    for (size_t t = 0; t < tasks.GetSize(); ++t) {
+      for (task_io_t sol : tasks.GetTask(t).solutions) outputs.emplace_back(sol);
+    }
+    const size_t sol_cnt = outputs.size();
+    for (size_t i = 0; i < sol_cnt; ++i) outputs.emplace_back(rnd.GetUInt());
+    emp::Shuffle(rnd, outputs);
+    size_t next = 0;
+    suite.Run(name, [&tasks, &outputs, &next](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) {
+        tasks.Submit(outputs[next]);
+        if (++next == outputs.size()) { next = 0; tasks.Reset(); }
+      }
+    });
+  }
+
+  /// Time a generation of selection (with births and mutations), then the update that swaps in the new population.
+  /// Evaluations aren't rerun: fitness comes from the (now stale) phenotype cache, as it does right after evaluation.
+  void BenchSelection(BenchmarkSuite & suite, const std::string & name) {
+    suite.Run(name, [this](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) {
+        do_selection_sig.Trigger();
+        Update();
+        ClearCache();
+      }
+    }, POP_SIZE);
+  }
+
+  /// Time just the lexicase selection events for a generation (no births).
+  void BenchLexicaseEvents(BenchmarkSuite & suite, const std::string & name) {
+    FillLexicaseScores();
+    uint64_t seed = BENCH_SEED;
+    suite.Run(name, [this, &seed](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) lexicase_selector.Select(lexicase_scores, eval_pool, seed++, POP_SIZE, lexicase_winners);
+    }, POP_SIZE);
+  }
+
+  /// Time MAP-Elites insertion of single offspring (unbatched, as in SetMapElites).
+  /// Meant for a world with mutations turned off and genome caching on: every offspring is a genome cache hit (no
+  /// evaluation), and lands in (and takes over) its parent's cell.
+  void BenchMapeInsert(BenchmarkSuite & suite, const std::string & name) {
+    emp::vector<size_t> occupied;
+    for (size_t id = 0; id < GetSize(); ++id) {
+      if (IsOccupied(id)) occupied.emplace_back(id);
+    }
+    emp::Random rnd(BENCH_SEED);
+    suite.Run(name, [this, &occupied, &rnd](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) {
+        const size_t parent = occupied[rnd.GetUInt(occupied.size())];
+        DoBirth(GetGenomeAt(parent), parent);
+      }
+    });
+  }
+
+  /// Time MAP-Elites insertion of batched offspring (see DoMapeBatch); same caveats as BenchMapeInsert.
+  void BenchMapeBatch(BenchmarkSuite & suite, const std::string & name) {
+    suite.Run(name, [this](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) DoMapeBatch(MAPE_BATCH_SIZE);
+    }, MAPE_BATCH_SIZE);
+  }
+
+  /// Time every snapshot that applies to this world's structure.
+  void BenchSnapshots(BenchmarkSuite & suite, const std::string & prefix) {
+    const std::string fpath = DATA_DIRECTORY + "bench_pop";
+    suite.Run(prefix + "programs", [this](size_t ops) { for (size_t i = 0; i < ops; ++i) Snapshot_Programs(); });
+    suite.Run(prefix + "programs_text", [this, &fpath](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) Snapshot_ProgramsText(fpath + ".pop");
+    });
+    suite.Run(prefix + "programs_binary", [this, &fpath](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) Snapshot_ProgramsBinary(fpath + ".popb");
+    });
+    suite.Run(prefix + "population_stats", [this](size_t ops) { for (size_t i = 0; i < ops; ++i) Snapshot_PopulationStats(); });
+    if (WORLD_STRUCTURE == (size_t)WORLD_MODE::WELL_MIXED) {
+      suite.Run(prefix + "dominant", [this](size_t ops) { for (size_t i = 0; i < ops; ++i) Snapshot_Dominant(); });
+    } else {
+      suite.Run(prefix + "map", [this](size_t ops) { for (size_t i = 0; i < ops; ++i) Snapshot_MAP(); });
+    }
+  }
+};
+
+/// Snapshots taken by both SignalGP world structures (see SignalGPBenchWorld::BenchSnapshots).
+const emp::vector<std::string> SIGNALGP_SNAPSHOTS = {"programs", "programs_text", "programs_binary", "population_stats"};
+
+/// Problem names (as used in benchmark names), indexed by PROBLEM_TYPE.
+const emp::vector<std::string> PROBLEM_NAMES = {"chgenv", "testcases", "logic"};
+
+/// Benchmarks that need a (started) well-mixed SignalGP world for each problem.
+void BenchSignalGPProblems(BenchmarkSuite & suite, MapElitesGPConfig & config) {
+  for (size_t problem = 0; problem < PROBLEM_NAMES.size(); ++problem) {
+    const std::string & pname = PROBLEM_NAMES[problem];
+    const bool is_testcases = problem == (size_t)MapElitesSignalGPWorld::PROBLEM_TYPE::TESTCASES;
+    const bool is_logic = problem == (size_t)MapElitesSignalGPWorld::PROBLEM_TYPE::LOGIC;
+    emp::vector<std::string> names = {"signalgp/inst/problem/" + pname, "signalgp/evaluate/" + pname};
+    if (is_logic) names.emplace_back("taskset/submit");
+    if (is_testcases) {
+      for (const auto & entry : INST_CLASSES) names.emplace_back("signalgp/inst/" + entry.first);
+      for (const std::string & snapshot : SIGNALGP_SNAPSHOTS) names.emplace_back("signalgp/snapshot/" + snapshot);
+      names.emplace_back("signalgp/snapshot/dominant");
+      names.emplace_back("signalgp/calc_genome_info");
+      names.emplace_back("signalgp/select/tournament");
+    }
+    if (!suite.IsAnySelected(names)) continue;
+    ConfigOverrides overrides(config);
+    overrides.Set("WORLD_STRUCTURE", "0").Set("PROBLEM_TYPE", emp::to_string(problem)).Set("SELECTION_METHOD", "0")
+             .Set("DATA_DIRECTORY", "signalgp_" + pname + "/");
+    emp::Random rnd(BENCH_SEED);
+    SignalGPBenchWorld world(rnd);
+    world.Setup(config);
+    world.Start();
+    world.EvaluateAll();
+    world.BenchInstClasses(suite, pname, is_testcases);
+    world.BenchEvaluate(suite, "signalgp/evaluate/" + pname);
+    if (is_logic) world.BenchTaskSubmit(suite, "taskset/submit");
+    if (is_testcases) {
+      world.BenchCalcGenomeInfo(suite, "signalgp/calc_genome_info");
+      world.BenchSnapshots(suite, "signalgp/snapshot/");
+      // Selection turns over the population, so it goes last.
+      world.BenchSelection(suite, "signalgp/select/tournament");
+    }
+  }
+}
+
+/// Lexicase selection (testcases problem).
+void BenchSignalGPLexicase(BenchmarkSuite & suite, MapElitesGPConfig & config) {
+  if (!suite.IsAnySelected({"signalgp/select/lexicase", "signalgp/select/lexicase_events"})) return;
+  ConfigOverrides overrides(config);
+  overrides.Set("WORLD_STRUCTURE", "0").Set("PROBLEM_TYPE", "1").Set("SELECTION_METHOD", "1")
+           .Set("DATA_DIRECTORY", "signalgp_lexicase/");
+  emp::Random rnd(BENCH_SEED);
+  SignalGPBenchWorld world(rnd);
+  world.Setup(config);
+  world.Start();
+  world.EvaluateAll();
+  world.BenchLexicaseEvents(suite, "signalgp/select/lexicase_events");
+  world.BenchSelection(suite, "signalgp/select/lexicase");
+}
+
+/// MAP-Elites insertion and MAP-Elites snapshots (testcases problem, no mutations, genome caching on).
+void BenchSignalGPMape(BenchmarkSuite & suite, MapElitesGPConfig & config) {
+  emp::vector<std::string> names = {"signalgp/mape/insert", "signalgp/mape/insert_batch", "signalgp/snapshot_mape/map"};
+  for (const std::string & snapshot : SIGNALGP_SNAPSHOTS) names.emplace_back("signalgp/snapshot_mape/" + snapshot);
+  if (!suite.IsAnySelected(names)) return;
+  ConfigOverrides overrides(config);
+  overrides.Set("WORLD_STRUCTURE", "1").Set("PROBLEM_TYPE", "1").Set("SHUFFLE_TEST_CASES", "0")
+           .Set("TESTCASE_SAMPLING", "0").Set("GENOME_CACHE_SIZE", "65536")
+           .Set("MAPE_BATCH_SIZE", emp::to_string(BENCH_MAPE_BATCH_SIZE)).Set("DATA_DIRECTORY", "signalgp_mape/");
+  for (const char * rate : {"ARG_SUB__PER_ARG", "INST_SUB__PER_INST", "INST_INS__PER_INST", "INST_DEL__PER_INST",
+                           "SLIP__PER_FUNC", "FUNC_DUP__PER_FUNC", "FUNC_DEL__PER_FUNC", "TAG_BIT_FLIP__PER_BIT"}) {
+    overrides.Set(rate, "0");
+  }
+  emp::Random rnd(BENCH_SEED);
+  SignalGPBenchWorld world(rnd);
+  world.Setup(config);
+  world.Start();
+  world.BenchMapeInsert(suite, "signalgp/mape/insert");
+  world.BenchMapeBatch(suite, "signalgp/mape/insert_batch");
+  world.BenchSnapshots(suite, "signalgp/snapshot_mape/");
+}
+
+/// ScopeGP evaluation (testcases and logic problems; ScopeGP has no changing environment problem) and snapshots.
+void BenchScopeGP(BenchmarkSuite & suite, MapElitesGPConfig & config) {
+  for (size_t problem : {(size_t)MapElitesScopeGPWorld::PROBLEM_TYPE::TESTCASES, (size_t)MapElitesScopeGPWorld::PROBLEM_TYPE::LOGIC}) {
+    const std::string & pname = PROBLEM_NAMES[problem];
+    const bool is_testcases = problem == (size_t)MapElitesScopeGPWorld::PROBLEM_TYPE::TESTCASES;
+    emp::vector<std::string> names = {"scopegp/evaluate/" + pname};
+    if (is_testcases) { names.emplace_back("scopegp/snapshot/single_file"); names.emplace_back("scopegp/snapshot/binary"); }
+    if (!suite.IsAnySelected(names)) continue;
+    ConfigOverrides overrides(config);
+    overrides.Set("WORLD_STRUCTURE", "0").Set("PROBLEM_TYPE", emp::to_string(problem)).Set("SELECTION_METHOD", "0");
+    // ScopeGP writes its data files to the working directory.
+    const std::string cwd = GetCwd();
+    EnterDir("scopegp_" + pname);
+    {
+      emp::Random rnd(BENCH_SEED);
+      MapElitesScopeGPWorld world(rnd);
+      world.Setup(config);
+      uint32_t seed = BENCH_SEED;
+      size_t next = 0;
+      suite.Run("scopegp/evaluate/" + pname, [&world, &seed, &next](size_t ops) {
+        for (size_t i = 0; i < ops; ++i, next = (next + 1) % world.GetSize()) world.Evaluate(world.GetOrg(next), world.eval_ctxs[0], seed++);
+      });
+      if (is_testcases) {
+        suite.Run("scopegp/snapshot/single_file", [&world](size_t ops) {
+          for (size_t i = 0; i < ops; ++i) world.SnapshotSingleFile(world.GetUpdate());
+        });
+        suite.Run("scopegp/snapshot/binary", [&world](size_t ops) {
+          for (size_t i = 0; i < ops; ++i) world.SnapshotBinary(world.GetUpdate(), "bench_pop.popb");
+        });
+      }
+    }
+    EnterDir(cwd);
+  }
+}
+
+/// Loading every testcase file (parsing, then from the binary cache).
+void BenchTestcaseLoading(BenchmarkSuite & suite, const emp::vector<std::string> & fpaths) {
+  for (const std::string & fpath : fpaths) {
+    const std::string fname = fpath.substr(fpath.find_last_of('/') + 1);
+    if (!suite.IsAnySelected({"testcases/load/" + fname, "testcases/load_cached/" + fname})) continue;
+    suite.Run("testcases/load/" + fname, [&fpath](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) { TestcaseSet<double, double> testcases; testcases.LoadTestcases(fpath); }
+    });
+    suite.Run("testcases/load_cached/" + fname, [&fpath](size_t ops) {
+      for (size_t i = 0; i < ops; ++i) { TestcaseSet<double, double> testcases; testcases.LoadTestcases(fpath, true, true); }
+    });
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::string config_fname = "configs/MapElitesGPConfig.cfg";
+  std::string out_fpath = "bench.json";
+  std::string testcases_dir = "configs/testcases";
+  std::string scratch_dir = "bench_scratch";
+  BenchmarkSuite suite("MAPE_BENCH");
+  // Pull out benchmark options; everything else goes to the config.
+  emp::vector<char *> config_argv;
+  for (int i = 0; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    const bool has_val = i + 1 < argc;
+    if (has_val && arg == "--bench-out") out_fpath = argv[++i];
+    else if (has_val && arg == "--bench-config") config_fname = argv[++i];
+    else if (has_val && arg == "--bench-filter") suite.SetFilter(argv[++i]);
+    else if (has_val && arg == "--bench-min-time") suite.SetMinTime(std::stod(argv[++i]));
+    else if (has_val && arg == "--bench-repeats") suite.SetRepeatCnt(std::stoul(argv[++i]));
+    else if (has_val && arg == "--bench-testcases") testcases_dir = argv[++i];
+    else if (has_val && arg == "--bench-scratch") scratch_dir = argv[++i];
+    else config_argv.emplace_back(argv[i]);
+  }
+  MapElitesGPConfig config;
+  config.Read(config_fname);
+  SetBenchDefaults(config);
+  auto args = emp::cl::ArgManager((int)config_argv.size(), config_argv.data());
+  if (args.ProcessConfigOptions(config, std::cout, config_fname, "MapElitesGP-macros.h") == false) exit(0);
+  if (args.TestUnknown() == false) exit(0);  // If there are leftover args, throw an error.
+
+  // Everything happens in the scratch directory (benchmarks write data files, snapshots, and testcase caches).
+  // Testcase files are copied in, so testcase caches don't end up next to the originals.
+  const std::string start_dir = GetCwd();
+  if (out_fpath[0] != '/') out_fpath = start_dir + "/" + out_fpath;
+  if (testcases_dir[0] != '/') testcases_dir = start_dir + "/" + testcases_dir;
+  const emp::vector<std::string> testcase_fnames = ListTestcaseFiles(testcases_dir);
+  EnterDir(scratch_dir);
+  const std::string scratch_testcases_dir = GetCwd() + "/testcases";
+  mkdir(scratch_testcases_dir.c_str(), ACCESSPERMS);
+  emp::vector<std::string> testcase_fpaths;
+  for (const std::string & fname : testcase_fnames) {
+    testcase_fpaths.emplace_back(scratch_testcases_dir + "/" + fname);
+    CopyFile(testcases_dir + "/" + fname, testcase_fpaths.back());
+  }
+  const std::string testcases_fpath = config.TESTCASES_FPATH();
+  const std::string testcases_fname = testcases_fpath.substr(testcases_fpath.find_last_of('/') + 1);
+  if (std::find(testcase_fnames.begin(), testcase_fnames.end(), testcases_fname) == testcase_fnames.end()) {
+    std::cout << "Testcase file (" << testcases_fname << ") not found in " << testcases_dir << ". Exiting..." << std::endl;
+    exit(-1);
+  }
+  config.TESTCASES_FPATH(scratch_testcases_dir + "/" + testcases_fname);
+
+  suite.AddContext("config", config_fname);
+  suite.AddContext("testcases", testcases_fname);
+  for (const char * setting : {"POP_SIZE", "EVAL_TIME", "EVAL_TRIAL_CNT", "EVAL_THREADS", "NUM_TEST_CASES",
+                                      "TOURNAMENT_SIZE", "DOM_SNAPSHOT_TRIAL_CNT", "MAP_SNAPSHOT_TRIAL_CNT", "POP_SNAPSHOT_FORMAT"}) {
+    suite.AddContext(setting, config.Get(setting));
+  }
+  suite.AddContext("hardware_threads", emp::to_string(std::thread::hardware_concurrency()));
+  #ifdef __VERSION__
+  suite.AddContext("compiler", __VERSION__);
+  #endif
+
+  BenchTestcaseLoading(suite, testcase_fpaths);
+  BenchSignalGPProblems(suite, config);
+  BenchSignalGPLexicase(suite, config);
+  BenchSignalGPMape(suite, config);
+  BenchScopeGP(suite, config);
+
+  if (!suite.Write(out_fpath)) {
+    std::cout << "Failed to write benchmark results (" << out_fpath << "). Exiting..." << std::endl;
+    exit(-1);
+  }
+  std::cout << "Wrote " << suite.GetResults().size() << " benchmark results to " << out_fpath << std::endl;
+}
@@ -0,0 +1,721 @@
+// This is the main function for the NATIVE test suite ('make test').
+// Each test checks something a run relies on (and that's easy to break while making things faster) against an
+// independent, slower way of getting the same answer.
+//
+// Usage: ./MAPE_TEST [--test-filter STR] [--test-config configs/MapElitesGPConfig.cfg]
+//                    [--test-testcases configs/testcases/examples-squares.csv] [--test-scratch test_scratch]
+//                    [-CONFIG_SETTING VALUE ...]
+// Config settings start from the config file, then the test defaults (see SetTestDefaults), then the command line.
+// Exits with a nonzero status if any check fails.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "base/Ptr.h"
+#include "base/vector.h"
+#include "config/command_line.h"
+#include "config/ArgManager.h"
+#include "hardware/signalgp_utils.h"
+#include "tools/Random.h"
+#include "tools/random_utils.h"
+#include "tools/string_utils.h"
+
+#include "../MapElitesSignalGP_World.h"
+#include "../MapElitesScopeGP_World.h"
+#include "../ProgramMutator.h"
+#include "DriverUtils.h"
+
+constexpr int TEST_SEED = 1;
+constexpr size_t TEST_NEVER = 1000000000;  ///< Data/snapshot interval that never comes up during tests.
+constexpr size_t TEST_LINEAGE_CNT = 20;    ///< Random programs to mutate (see TestMutatorHistogram).
+constexpr size_t TEST_LINEAGE_LEN = 250;   ///< Generations of mutations per random program.
+constexpr size_t TEST_UPDATES = 5;         ///< Updates to run worlds for.
+constexpr size_t TEST_EVAL_THREADS = 4;    ///< EVAL_THREADS to compare against serial evaluation.
+constexpr size_t TEST_SELECTIONS = 1000;   ///< Selection events per selection test.
+constexpr size_t TEST_POOL_ROUNDS = 50;    ///< Resize/Run rounds per worker pool test.
+constexpr size_t TEST_CHECKPOINT_INTERVAL = 2;  ///< CHECKPOINT_INTERVAL for resume tests.
+constexpr size_t TEST_RESUME_UPDATE = 2;   ///< Checkpointed update resume tests pick up from.
+
+/// Runs (selected) tests and keeps track of failed checks.
+class TestSuite {
+protected:
+  std::string filter;    ///< Only run tests whose name contains filter.
+  size_t test_cnt;
+  size_t check_cnt;
+  emp::vector<std::string> failed;  ///< Names of tests with failed checks.
+  std::string cur_test;
+  bool cur_failed;
+
+public:
+  TestSuite() : filter(), test_cnt(0), check_cnt(0), failed(), cur_test(), cur_failed(false) { ; }
+
+  void SetFilter(const std::string & str) { filter = str; }
+
+  /// Will a test with this name be run (given the filter)?
+  bool IsSelected(const std::string & name) const { return name.find(filter) != std::string::npos; }
+
+  /// Run test name (if selected).
+  void Run(const std::string & name, const std::function<void()> & body) {
+    if (!IsSelected(name)) return;
+    cur_test = name;
+    cur_failed = false;
+    ++test_cnt;
+    std::cout << "Running " << name << std::endl;
+    body();
+    if (cur_failed) failed.emplace_back(name);
+  }
+
+  /// Record a check (what describes what's being checked); returns ok.
+  bool Check(bool ok, const std::string & what) {
+    ++check_cnt;
+    if (!ok) {
+      std::cout << "  FAILED (" << cur_test << "): " << what << std::endl;
+      cur_failed = true;
+    }
+    return ok;
+  }
+
+  /// Print a summary; returns whether every check passed.
+  bool Report() const {
+    std::cout << test_cnt << " tests, " << check_cnt << " checks, " << failed.size() << " tests failed" << std::endl;
+    for (const std::string & name : failed) std::cout << "  " << name << std::endl;
+    return failed.empty();
+  }
+};
+
+/// Settings every test starts from (before command line overrides): small, deterministic, and quiet (no periodic
+/// data files or snapshots, no checkpoints).
+void SetTestDefaults(MapElitesGPConfig & config) {
+  config.RANDOM_SEED(TEST_SEED);
+  config.POP_SIZE(64);
+  config.GENERATIONS(0);
+  config.POP_INIT_METHOD(0);
+  config.EVAL_TIME(64);
+  config.NUM_TEST_CASES(10);
+  config.STATISTICS_INTERVAL(TEST_NEVER);
+  config.SNAPSHOT_INTERVAL(TEST_NEVER);
+  config.CHECKPOINT_INTERVAL(0);
+  config.RESUME(false);
+  config.PHASE_TIMING(false);
+}
+
+/// Mutation rates high enough that every mutation operator fires in (almost) every generation.
+void SetHighMutationRates(ConfigOverrides & overrides) {
+  overrides.Set("ARG_SUB__PER_ARG", "0.1").Set("INST_SUB__PER_INST", "0.1").Set("INST_INS__PER_INST", "0.1")
+           .Set("INST_DEL__PER_INST", "0.1").Set("SLIP__PER_FUNC", "0.5").Set("FUNC_DUP__PER_FUNC", "0.25")
+           .Set("FUNC_DEL__PER_FUNC", "0.25").Set("TAG_BIT_FLIP__PER_BIT", "0.05");
+}
+
+/// Are a and b the same bits? (Unlike ==, NaNs can match.)
+bool SameBits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+/// A world to test: a name and config settings.
+struct TestWorldSetup {
+  std::string name;
+  emp::vector<std::pair<std::string, std::string>> settings;
+};
+
+/// No mutations (offspring are copies of their parents).
+void SetNoMutations(ConfigOverrides & overrides) {
+  for (const char * rate : {"ARG_SUB__PER_ARG", "INST_SUB__PER_INST", "INST_INS__PER_INST", "INST_DEL__PER_INST",
+                           "SLIP__PER_FUNC", "FUNC_DUP__PER_FUNC", "FUNC_DEL__PER_FUNC", "TAG_BIT_FLIP__PER_BIT"}) {
+    overrides.Set(rate, "0");
+  }
+}
+
+/// SignalGP world with tests for its insides.
+class SignalGPTestWorld : public MapElitesSignalGPWorld {
+public:
+  SignalGPTestWorld(emp::Random & rnd) : MapElitesSignalGPWorld(rnd) { ; }
+
+  /// Do everything Run does before its first update (including restoring the checkpoint, if resuming).
+  void Start() {
+    do_begin_run_sig.Trigger();
+    if (resuming) RestoreCheckpoint();
+    else do_pop_init_sig.Trigger();
+  }
+
+  bool IsWellMixed() const { return WORLD_STRUCTURE == (size_t)WORLD_MODE::WELL_MIXED; }
+  size_t GetEvalThreads() const { return EVAL_THREADS; }
+
+  /// Evaluate the population (well-mixed worlds; MAP-Elites evaluates organisms as they're placed).
+  void EvaluateAll() { do_evaluation_sig.Trigger(); }
+
+  /// The rest of a (well-mixed) update, after evaluation: selection, then swapping in the new population.
+  void SelectAndUpdate() {
+    do_selection_sig.Trigger();
+    do_world_update_sig.Trigger();
+  }
+
+  /// Configure mutator with the world's program limits and mutation rates high enough that every operator fires.
+  void SetTestMutatorSettings(emp::SignalGPMutator<org_t::TAG_WIDTH> & test_mutator) const {
+    test_mutator.SetProgMinFuncCnt(PROG_MIN_FUNC_CNT);
+    test_mutator.SetProgMaxFuncCnt(PROG_MAX_FUNC_CNT);
+    test_mutator.SetProgMinFuncLen(PROG_MIN_FUNC_LEN);
+    test_mutator.SetProgMaxFuncLen(PROG_MAX_FUNC_LEN);
+    test_mutator.SetProgMaxTotalLen(PROG_MAX_TOTAL_LEN);
+    test_mutator.SetProgMinArgVal(PROG_MIN_ARG_VAL);
+    test_mutator.SetProgMaxArgVal(PROG_MAX_ARG_VAL);
+    test_mutator.ARG_SUB__PER_ARG(0.1);
+    test_mutator.INST_SUB__PER_INST(0.1);
+    test_mutator.INST_INS__PER_INST(0.1);
+    test_mutator.INST_DEL__PER_INST(0.1);
+    test_mutator.SLIP__PER_FUNC(0.5);
+    test_mutator.FUNC_DUP__PER_FUNC(0.25);
+    test_mutator.FUNC_DEL__PER_FUNC(0.25);
+    test_mutator.TAG_BIT_FLIP__PER_BIT(0.05);
+  }
+
+  /// Mutate lineages of random programs (with the world's program limits and high mutation rates), checking after
+  /// every generation that the instruction histogram ProgramMutator kept up to date matches a full recount, and
+  /// that each lineage matches one mutated by emp::SignalGPMutator (from the same seed) program for program.
+  void TestMutatorHistogram(TestSuite & suite) {
+    ProgramMutator<org_t::TAG_WIDTH> test_mutator;
+    emp::SignalGPMutator<org_t::TAG_WIDTH> emp_mutator;
+    SetTestMutatorSettings(test_mutator);
+    SetTestMutatorSettings(emp_mutator);
+    // Random programs start out within the total length limit.
+    const size_t gen_max_func_len = emp::Min(PROG_MAX_FUNC_LEN, PROG_MAX_TOTAL_LEN / PROG_MAX_FUNC_CNT);
+    emp::Random rnd(TEST_SEED);
+    emp::Random mut_rnd(TEST_SEED + 1);
+    emp::Random emp_rnd(TEST_SEED + 1);
+    size_t mut_cnt = 0;
+    size_t mismatch_cnt = 0;
+    size_t emp_diff_cnt = 0;
+    for (size_t lineage = 0; lineage < TEST_LINEAGE_CNT; ++lineage) {
+      program_t prog(emp::GenRandSignalGPProgram(rnd, inst_lib, PROG_MIN_FUNC_CNT, PROG_MAX_FUNC_CNT,
+                                                 PROG_MIN_FUNC_LEN, gen_max_func_len,
+                                                 PROG_MIN_ARG_VAL, PROG_MAX_ARG_VAL));
+      emp::Ptr<org_t> org = emp::NewPtr<org_t>(genome_t(prog, HW_MIN_TAG_SIMILARITY_THRESH));
+      org->CalcGenomeInfo();
+      program_t emp_prog(prog);
+      for (size_t gen = 0; gen < TEST_LINEAGE_LEN; ++gen) {
+        emp::Ptr<org_t> offspring = emp::NewPtr<org_t>(org->GetGenome());
+        offspring->InheritGenomeInfo(*org);
+        const size_t muts = test_mutator.ApplyMutations(offspring->GetProgram(), mut_rnd, offspring->GetInstHistogram());
+        if (muts) offspring->ResetInstEntropy();
+        mut_cnt += muts;
+        if (!offspring->CheckGenomeInfo()) ++mismatch_cnt;
+        const size_t emp_muts = emp_mutator.ApplyMutations(emp_prog, emp_rnd);
+        if (muts != emp_muts || !(offspring->GetProgram() == emp_prog)) ++emp_diff_cnt;
+        org.Delete();
+        org = offspring;
+      }
+      org.Delete();
+    }
+    suite.Check(mut_cnt > 0, "mutations happened");
+    suite.Check(mismatch_cnt == 0, emp::to_string(mismatch_cnt) + " mutated histograms differ from a full recount");
+    suite.Check(emp_diff_cnt == 0, emp::to_string(emp_diff_cnt) + " mutated programs differ from emp::SignalGPMutator's");
+  }
+
+  /// Run updates; in well-mixed worlds, every organism gets its genome information calculated before each update
+  /// (MAP-Elites calculates it for everything it places), so offspring have something to inherit.
+  void RunUpdates(size_t updates) {
+    for (size_t u = 0; u < updates; ++u) {
+      if (WORLD_STRUCTURE == (size_t)WORLD_MODE::WELL_MIXED) {
+        for (size_t id = 0; id < GetSize(); ++id) if (IsOccupied(id)) GetOrg(id).CalcGenomeInfo();
+      }
+      RunStep();
+    }
+  }
+
+  /// Every organism should have inherited (and kept up to date) genome information matching a full recount.
+  void TestPopGenomeInfo(TestSuite & suite) {
+    size_t org_cnt = 0;
+    size_t missing_cnt = 0;
+    size_t mismatch_cnt = 0;
+    for (size_t id = 0; id < GetSize(); ++id) {
+      if (!IsOccupied(id)) continue;
+      ++org_cnt;
+      org_t & org = GetOrg(id);
+      if (!org.HasGenomeInfo()) ++missing_cnt;
+      else if (!org.CheckGenomeInfo()) ++mismatch_cnt;
+    }
+    suite.Check(org_cnt > 0, "population isn't empty");
+    suite.Check(missing_cnt == 0, emp::to_string(missing_cnt) + " organisms without genome information");
+    suite.Check(mismatch_cnt == 0, emp::to_string(mismatch_cnt) + " organisms' genome information differs from a full recount");
+  }
+
+  /// Population, phenotypes, and fitnesses must be bit-identical to other's.
+  void TestSameAs(TestSuite & suite, SignalGPTestWorld & other, const std::string & what) {
+    if (!suite.Check(GetSize() == other.GetSize(), what + ": population sizes differ")) return;
+    size_t genome_diff_cnt = 0;
+    size_t phen_diff_cnt = 0;
+    size_t fitness_diff_cnt = 0;
+    for (size_t id = 0; id < GetSize(); ++id) {
+      if (IsOccupied(id) != other.IsOccupied(id)) { ++genome_diff_cnt; continue; }
+      if (!IsOccupied(id)) continue;
+      if (!(GetGenomeAt(id) == other.GetGenomeAt(id))) { ++genome_diff_cnt; continue; }
+      if (!phen_cache.SameOrg(id, other.phen_cache, id)) ++phen_diff_cnt;
+      if (!SameBits(CalcFitnessOrg(GetOrg(id)), other.CalcFitnessOrg(other.GetOrg(id)))) ++fitness_diff_cnt;
+    }
+    suite.Check(genome_diff_cnt == 0, what + ": " + emp::to_string(genome_diff_cnt) + " positions with different organisms");
+    suite.Check(phen_diff_cnt == 0, what + ": " + emp::to_string(phen_diff_cnt) + " organisms with different phenotypes");
+    suite.Check(fitness_diff_cnt == 0, what + ": " + emp::to_string(fitness_diff_cnt) + " organisms with different fitness");
+  }
+
+  /// Re-evaluate the (evaluated, well-mixed) population one organism at a time, in a random order, spreading
+  /// organisms across every evaluation context; phenotypes must be bit-identical to the ones in the phenotype cache.
+  void TestShuffledEvaluation(TestSuite & suite, emp::Random & rnd, const std::string & what) {
+    PhenotypeCache phens(GetSize(), EVAL_TRIAL_CNT, phen_cache.GetLayout());
+    emp::vector<size_t> order(GetSize());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    emp::Shuffle(rnd, order);
+    for (size_t i = 0; i < order.size(); ++i) {
+      EvaluateInto(GetOrg(order[i]), *eval_ctxs[i % eval_ctxs.size()], phens, order[i], order[i]);
+    }
+    size_t phen_diff_cnt = 0;
+    for (size_t id = 0; id < GetSize(); ++id) if (!phens.SameOrg(id, phen_cache, id)) ++phen_diff_cnt;
+    suite.Check(phen_diff_cnt == 0, what + ": " + emp::to_string(phen_diff_cnt) + " organisms with different phenotypes");
+  }
+
+  /// Evaluate a (well-mixed) population with duplicate genomes and nothing in the genome cache: each genome should be
+  /// evaluated once, and duplicates should end up with the phenotypes evaluating them would have given them.
+  void TestPopDedupe(TestSuite & suite, emp::Random & rnd) {
+    size_t unique_cnt = 0;
+    for (size_t id = 0; id < GetSize(); ++id) {
+      bool seen = false;
+      for (size_t other = 0; other < id && !seen; ++other) seen = GetGenomeAt(other) == GetGenomeAt(id);
+      if (!seen) ++unique_cnt;
+    }
+    suite.Check(unique_cnt < GetSize(), "population has duplicate genomes");
+    genome_cache.Clear();
+    genome_cache.ResetStats();
+    ResetEvalCnt();
+    EvaluateAll();
+    suite.Check(GetEvalCnt() == unique_cnt, emp::to_string(GetEvalCnt()) + " evaluations for " + emp::to_string(unique_cnt) + " genomes");
+    suite.Check(genome_cache.GetMissCnt() == unique_cnt && genome_cache.GetHitCnt() == GetSize() - unique_cnt,
+                "duplicates count as genome cache hits");
+    TestShuffledEvaluation(suite, rnd, "duplicate genomes");
+  }
+
+  /// Breed a MAP-Elites batch (without mutations, so it's full of duplicate genomes) with nothing in the genome
+  /// cache: each genome should be evaluated once, and duplicates should get their source's results.
+  void TestBatchDedupe(TestSuite & suite) {
+    const size_t batch_row = GetSize() + 1;
+    genome_cache.Clear();
+    DoMapeBatch(MAPE_BATCH_SIZE);
+    size_t dup_cnt = 0;
+    size_t dup_eval_cnt = 0;
+    size_t diff_cnt = 0;
+    for (size_t i = 0; i < MAPE_BATCH_SIZE; ++i) {
+      const size_t source = mape_batch.sources[i];
+      if (source == MapeBatch::NO_SOURCE) {
+        for (size_t j = 0; j < i; ++j) {
+          if (mape_batch.streams[i] != MapeBatch::NO_EVAL && mape_batch.streams[j] != MapeBatch::NO_EVAL
+              && mape_batch.hashes[i] == mape_batch.hashes[j]) ++dup_eval_cnt;
+        }
+        continue;
+      }
+      ++dup_cnt;
+      if (mape_batch.streams[i] != MapeBatch::NO_EVAL) ++dup_eval_cnt;
+      if (source >= i || mape_batch.hashes[source] != mape_batch.hashes[i]
+          || !phen_cache.SameOrg(batch_row + i, phen_cache, batch_row + source)
+          || !SameBits(mape_batch.fitness[i], mape_batch.fitness[source]) || mape_batch.cells[i] != mape_batch.cells[source]) {
+        ++diff_cnt;
+      }
+    }
+    suite.Check(dup_cnt > 0, "batch has duplicate genomes");
+    suite.Check(dup_eval_cnt == 0, emp::to_string(dup_eval_cnt) + " duplicate genomes evaluated");
+    suite.Check(diff_cnt == 0, emp::to_string(diff_cnt) + " duplicates with results different from their source's");
+  }
+};
+
+/// ScopeGP world with tests for its insides.
+class ScopeGPTestWorld : public MapElitesScopeGPWorld {
+public:
+  ScopeGPTestWorld(emp::Random & rnd) : MapElitesScopeGPWorld(rnd) { ; }
+
+  /// Do everything Run does before its first update (nothing: Setup initializes or restores the population).
+  void Start() { ; }
+
+  void RunUpdates(size_t updates) {
+    for (size_t u = 0; u < updates; ++u) RunStep();
+  }
+
+  /// Are a and b the same evaluation (bit for bit)?
+  static bool SameEval(const OrgEval & a, const OrgEval & b) {
+    if (!SameBits(a.fitness, b.fitness) || a.scopes != b.scopes || !SameBits(a.inst_entropy, b.inst_entropy)) return false;
+    if (a.case_scores.size() != b.case_scores.size()) return false;
+    for (size_t i = 0; i < a.case_scores.size(); ++i) if (!SameBits(a.case_scores[i], b.case_scores[i])) return false;
+    return true;
+  }
+
+  /// Population, evaluations, and fitnesses must be bit-identical to other's.
+  void TestSameAs(TestSuite & suite, ScopeGPTestWorld & other, const std::string & what) {
+    if (!suite.Check(GetSize() == other.GetSize(), what + ": population sizes differ")) return;
+    size_t genome_diff_cnt = 0;
+    size_t eval_diff_cnt = 0;
+    size_t fitness_diff_cnt = 0;
+    for (size_t id = 0; id < GetSize(); ++id) {
+      if (IsOccupied(id) != other.IsOccupied(id)) { ++genome_diff_cnt; continue; }
+      if (!IsOccupied(id)) continue;
+      if (!(pop[id]->GetGenome().sequence == other.pop[id]->GetGenome().sequence)) { ++genome_diff_cnt; continue; }
+      if (!SameEval(GetEval(*pop[id]), other.GetEval(*other.pop[id]))) ++eval_diff_cnt;
+      if (!SameBits(CalcFitnessID(id), other.CalcFitnessID(id))) ++fitness_diff_cnt;
+    }
+    suite.Check(genome_diff_cnt == 0, what + ": " + emp::to_string(genome_diff_cnt) + " positions with different organisms");
+    suite.Check(eval_diff_cnt == 0, what + ": " + emp::to_string(eval_diff_cnt) + " organisms with different evaluations");
+    suite.Check(fitness_diff_cnt == 0, what + ": " + emp::to_string(fitness_diff_cnt) + " organisms with different fitness");
+  }
+};
+
+/// Get (sorted) names of the regular files in dir.
+emp::vector<std::string> ListFiles(const std::string & dir) {
+  emp::vector<std::string> fnames;
+  DIR * dp = opendir(dir.c_str());
+  if (!dp) return fnames;
+  while (dirent * entry = readdir(dp)) {
+    const std::string fname(entry->d_name);
+    struct stat st;
+    if (stat((dir + "/" + fname).c_str(), &st) == 0 && S_ISREG(st.st_mode)) fnames.emplace_back(fname);
+  }
+  closedir(dp);
+  std::sort(fnames.begin(), fnames.end());
+  return fnames;
+}
+
+std::string ReadFile(const std::string & fpath) {
+  std::ifstream ifs(fpath, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+/// Incrementally updated genome information (instruction histograms), standalone and in running worlds.
+void TestGenomeInfo(TestSuite & suite, MapElitesGPConfig & config) {
+  suite.Run("genome_info/mutator", [&config, &suite]() {
+    ConfigOverrides overrides(config);
+    overrides.Set("DATA_DIRECTORY", "genome_info_mutator/");
+    emp::Random rnd(TEST_SEED);
+    SignalGPTestWorld world(rnd);
+    world.Setup(config);
+    world.TestMutatorHistogram(suite);
+  });
+  // (name, (WORLD_STRUCTURE, MAPE_BATCH_SIZE))
+  const emp::vector<std::pair<std::string, std::pair<size_t, size_t>>> worlds = {
+    {"well_mixed", {0, 0}}, {"mape", {1, 0}}, {"mape_batch", {1, 16}}
+  };
+  for (const auto & entry : worlds) {
+    const std::string name = "genome_info/" + entry.first;
+    suite.Run(name, [&config, &suite, &entry]() {
+      ConfigOverrides overrides(config);
+      overrides.Set("WORLD_STRUCTURE", emp::to_string(entry.second.first)).Set("SELECTION_METHOD", "0")
+               .Set("MAPE_BATCH_SIZE", emp::to_string(entry.second.second))
+               .Set("DATA_DIRECTORY", "genome_info_" + entry.first + "/");
+      SetHighMutationRates(overrides);
+      emp::Random rnd(TEST_SEED);
+      SignalGPTestWorld world(rnd);
+      world.Setup(config);
+      world.Start();
+      world.RunUpdates(TEST_UPDATES);
+      world.TestPopGenomeInfo(suite);
+    });
+  }
+}
+
+/// Same seed with EVAL_THREADS=1 and EVAL_THREADS=TEST_EVAL_THREADS (and, in well-mixed worlds, re-evaluation in a
+/// shuffled order): populations, phenotypes, and fitnesses must be bit-identical, update after update.
+void TestEvalReproducibility(TestSuite & suite, MapElitesGPConfig & config) {
+  const emp::vector<TestWorldSetup> setups = {
+    {"testcases", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "1"}, {"SELECTION_METHOD", "0"}}},
+    {"testcases_genome_cache", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "1"}, {"SELECTION_METHOD", "0"},
+                                {"SHUFFLE_TEST_CASES", "0"}, {"TESTCASE_SAMPLING", "0"}, {"GENOME_CACHE_SIZE", "4096"}}},
+    {"testcases_lexicase", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "1"}, {"SELECTION_METHOD", "1"}}},
+    {"logic", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "2"}, {"SELECTION_METHOD", "0"}}},
+    {"chgenv", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "0"}, {"SELECTION_METHOD", "0"}, {"EVAL_TRIAL_CNT", "2"}}},
+    {"mape_batch", {{"WORLD_STRUCTURE", "1"}, {"PROBLEM_TYPE", "1"}, {"MAPE_BATCH_SIZE", "16"}}},
+    {"mape_batch_genome_cache", {{"WORLD_STRUCTURE", "1"}, {"PROBLEM_TYPE", "1"}, {"MAPE_BATCH_SIZE", "16"},
+                                 {"SHUFFLE_TEST_CASES", "0"}, {"TESTCASE_SAMPLING", "0"}, {"GENOME_CACHE_SIZE", "4096"}}}
+  };
+  const std::string threads = emp::to_string(TEST_EVAL_THREADS);
+  for (const TestWorldSetup & setup : setups) {
+    suite.Run("eval_repro/" + setup.name, [&config, &suite, &setup, &threads]() {
+      ConfigOverrides overrides(config);
+      for (const auto & setting : setup.settings) overrides.Set(setting.first, setting.second);
+      overrides.Set("EVAL_THREADS", "1").Set("DATA_DIRECTORY", "eval_repro_" + setup.name + "_serial/");
+      emp::Random serial_rnd(TEST_SEED);
+      SignalGPTestWorld serial(serial_rnd);
+      serial.Setup(config);
+      overrides.Set("EVAL_THREADS", threads).Set("DATA_DIRECTORY", "eval_repro_" + setup.name + "_threaded/");
+      emp::Random threaded_rnd(TEST_SEED);
+      SignalGPTestWorld threaded(threaded_rnd);
+      threaded.Setup(config);
+      suite.Check(threaded.GetEvalThreads() == TEST_EVAL_THREADS, "threaded world has " + threads + " evaluation workers");
+      serial.Start();
+      threaded.Start();
+      emp::Random order_rnd(TEST_SEED);
+      for (size_t u = 0; u < TEST_UPDATES; ++u) {
+        const std::string when = "update " + emp::to_string(u);
+        if (serial.IsWellMixed()) {
+          serial.EvaluateAll();
+          threaded.EvaluateAll();
+          serial.TestSameAs(suite, threaded, when + ", EVAL_THREADS=1 vs " + threads);
+          threaded.TestShuffledEvaluation(suite, order_rnd, when + ", shuffled evaluation order");
+          serial.SelectAndUpdate();
+          threaded.SelectAndUpdate();
+        } else {
+          serial.RunStep();
+          threaded.RunStep();
+          serial.TestSameAs(suite, threaded, when + ", EVAL_THREADS=1 vs " + threads);
+        }
+      }
+    });
+  }
+}
+
+/// Run a world for TEST_UPDATES updates (checkpointing every TEST_CHECKPOINT_INTERVAL updates), copying its data
+/// directory as of the checkpoint at TEST_RESUME_UPDATE. Then add a row to each copied file (as if the run had been
+/// killed a little after the checkpoint) and resume a second world from the copy. At the end, populations,
+/// phenotypes, and fitnesses must be bit-identical, and so must the data files (the resumed world cuts them back to
+/// the checkpoint and appends, without repeating headers). Runs in directories [name]_original and [name]_resumed;
+/// data_dir is where worlds write data files (and checkpoints) within them.
+template <typename WORLD_T>
+void TestResume(TestSuite & suite, MapElitesGPConfig & config, const std::string & name, const std::string & data_dir) {
+  const std::string scratch_dir = GetCwd();
+  const std::string original_dir = scratch_dir + "/" + name + "_original";
+  const std::string resumed_dir = scratch_dir + "/" + name + "_resumed";
+  ConfigOverrides overrides(config);
+  overrides.Set("CHECKPOINT_INTERVAL", emp::to_string(TEST_CHECKPOINT_INTERVAL)).Set("STATISTICS_INTERVAL", "1")
+           .Set("DATA_DIRECTORY", data_dir + "/").Set("RESUME", "0");
+  {
+    EnterDir(original_dir);
+    emp::Random original_rnd(TEST_SEED);
+    WORLD_T original(original_rnd);
+    original.Setup(config);
+    original.Start();
+    original.RunUpdates(TEST_RESUME_UPDATE);
+    mkdir(resumed_dir.c_str(), ACCESSPERMS);
+    mkdir((resumed_dir + "/" + data_dir).c_str(), ACCESSPERMS);
+    for (const std::string & fname : ListFiles(data_dir)) {
+      CopyFile(data_dir + "/" + fname, resumed_dir + "/" + data_dir + "/" + fname);
+    }
+    original.RunUpdates(TEST_UPDATES - TEST_RESUME_UPDATE);
+
+    EnterDir(resumed_dir);
+    for (const std::string & fname : ListFiles(data_dir)) {
+      if (fname == "checkpoint.ckpt") continue;
+      std::ofstream(data_dir + "/" + fname, std::ios::app) << "written after the checkpoint" << std::endl;
+    }
+    overrides.Set("RESUME", "1");
+    emp::Random resumed_rnd(TEST_SEED);
+    WORLD_T resumed(resumed_rnd);
+    resumed.Setup(config);
+    resumed.Start();
+    resumed.RunUpdates(TEST_UPDATES - TEST_RESUME_UPDATE);
+    EnterDir(scratch_dir);
+    suite.Check(resumed.GetUpdate() == TEST_UPDATES, "resumed world picked up at update " + emp::to_string(TEST_RESUME_UPDATE));
+    original.TestSameAs(suite, resumed, "update " + emp::to_string(TEST_UPDATES) + ", resumed vs original");
+  }
+  // (Worlds close their data files on the way out.)
+  const emp::vector<std::string> fnames = ListFiles(original_dir + "/" + data_dir);
+  suite.Check(fnames.size() > 1, "data files written");
+  suite.Check(fnames == ListFiles(resumed_dir + "/" + data_dir), "resumed world wrote the same data files");
+  size_t diff_cnt = 0;
+  std::string diff_fnames;
+  for (const std::string & fname : fnames) {
+    if (fname == "checkpoint.ckpt") continue;
+    if (ReadFile(original_dir + "/" + data_dir + "/" + fname) != ReadFile(resumed_dir + "/" + data_dir + "/" + fname)) {
+      ++diff_cnt;
+      diff_fnames += " " + fname;
+    }
+  }
+  suite.Check(diff_cnt == 0, emp::to_string(diff_cnt) + " data files differ from the original run's:" + diff_fnames);
+}
+
+/// Checkpoint/resume: a run resumed from a checkpoint must pick up exactly where the original left off.
+void TestCheckpointResume(TestSuite & suite, MapElitesGPConfig & config) {
+  const emp::vector<TestWorldSetup> signalgp_setups = {
+    {"testcases", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "1"}, {"SELECTION_METHOD", "0"}}},
+    {"logic_lexicase", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "2"}, {"SELECTION_METHOD", "1"}}},
+    {"mape_batch", {{"WORLD_STRUCTURE", "1"}, {"PROBLEM_TYPE", "1"}, {"MAPE_BATCH_SIZE", "16"}}}
+  };
+  for (const TestWorldSetup & setup : signalgp_setups) {
+    suite.Run("resume/signalgp_" + setup.name, [&config, &suite, &setup]() {
+      ConfigOverrides overrides(config);
+      for (const auto & setting : setup.settings) overrides.Set(setting.first, setting.second);
+      TestResume<SignalGPTestWorld>(suite, config, "resume_signalgp_" + setup.name, "data");
+    });
+  }
+  // ScopeGP writes data files (and checkpoints) to the working directory.
+  const emp::vector<TestWorldSetup> scopegp_setups = {
+    {"testcases", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "1"}, {"SELECTION_METHOD", "0"}}},
+    {"logic", {{"WORLD_STRUCTURE", "0"}, {"PROBLEM_TYPE", "2"}, {"SELECTION_METHOD", "0"}}},
+    {"mape_logic", {{"WORLD_STRUCTURE", "1"}, {"PROBLEM_TYPE", "2"}}}
+  };
+  for (const TestWorldSetup & setup : scopegp_setups) {
+    suite.Run("resume/scopegp_" + setup.name, [&config, &suite, &setup]() {
+      ConfigOverrides overrides(config);
+      for (const auto & setting : setup.settings) overrides.Set(setting.first, setting.second);
+      TestResume<ScopeGPTestWorld>(suite, config, "resume_scopegp_" + setup.name, ".");
+    });
+  }
+}
+
+/// WorkerPool that lets tests see how many workers have finished the current batch.
+class WorkerPoolProbe : public WorkerPool {
+public:
+  WorkerPoolProbe(size_t _worker_cnt) : WorkerPool(_worker_cnt) { ; }
+
+  size_t GetWorkersDone() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return workers_done;
+  }
+};
+
+/// WorkerPool resized between runs: every job must run exactly once, and be done by the time Run returns. Workers
+/// spawned by the resize must sit tight until the next Run (rather than running the last batch again, and counting
+/// themselves done with it).
+void TestWorkerPoolResize(TestSuite & suite) {
+  suite.Run("worker_pool/resize_after_run", [&suite]() {
+    const size_t job_cnt = 64;
+    emp::vector<std::atomic<size_t>> runs(job_cnt);
+    WorkerPoolProbe pool(2);
+    size_t bad_round_cnt = 0;
+    size_t stale_round_cnt = 0;
+    for (size_t round = 0; round < TEST_POOL_ROUNDS; ++round) {
+      for (std::atomic<size_t> & r : runs) r = 0;
+      pool.Run(job_cnt, [&runs](size_t worker_id, size_t job_id) {
+        // Slow jobs leave time for workers that shouldn't be running to show up.
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        ++runs[job_id];
+      });
+      bool ok = true;
+      for (const std::atomic<size_t> & r : runs) ok = ok && r == 1;
+      if (!ok) ++bad_round_cnt;
+      const size_t workers_done = pool.GetWorkersDone();
+      pool.Resize(2 + round % 3);
+      // Give new workers time to start up (and, if they're going to, act on the last batch).
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      if (pool.GetWorkersDone() != workers_done) ++stale_round_cnt;
+    }
+    suite.Check(bad_round_cnt == 0, emp::to_string(bad_round_cnt) + " rounds where Run returned before every job ran exactly once");
+    suite.Check(stale_round_cnt == 0, emp::to_string(stale_round_cnt) + " resizes where new workers finished a batch they weren't around for");
+  });
+}
+
+/// Lexicase selection with scores that aren't numbers.
+void TestLexicaseNaN(TestSuite & suite) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  // An organism (column) with NaN on every case: it must never win, and the organism that's strictly best on
+  // every case always should.
+  suite.Run("lexicase/nan_column", [&suite, nan]() {
+    const emp::vector<emp::vector<double>> results = {{nan, 1, 4, 2}, {nan, 0, 3, 3}, {nan, 2, 5, 1}};
+    ScoreMatrix scores;
+    scores.Resize(results.size(), results[0].size());
+    for (size_t c = 0; c < results.size(); ++c) {
+      for (size_t org_id = 0; org_id < results[c].size(); ++org_id) scores.Get(c, org_id) = ScoreMatrix::ToScore(results[c][org_id]);
+    }
+    suite.Check(scores.Get(0, 0) == ScoreMatrix::GetEmptyScore(), "NaN results get the empty score");
+    LexicaseSelector selector;
+    emp::Random rnd(TEST_SEED);
+    emp::vector<size_t> winners;
+    selector.Select(scores, rnd, TEST_SELECTIONS, winners);
+    size_t wrong_cnt = 0;
+    for (size_t winner : winners) wrong_cnt += (winner != 2);
+    suite.Check(wrong_cnt == 0, emp::to_string(wrong_cnt) + " selections didn't go to the best organism");
+  });
+  // NaNs that make it into the score matrix: a case with nothing tied for best (here, after the first case keeps
+  // organisms 0 and 1, the second case's best is NaN) must leave the candidates alone.
+  suite.Run("lexicase/nan_case", [&suite, nan]() {
+    const emp::vector<emp::vector<double>> results = {{1, 1, 0, 0}, {nan, 3, 9, 9}};
+    ScoreMatrix scores;
+    scores.Resize(results.size(), results[0].size());
+    for (size_t c = 0; c < results.size(); ++c) {
+      for (size_t org_id = 0; org_id < results[c].size(); ++org_id) scores.Get(c, org_id) = results[c][org_id];
+    }
+    LexicaseSelector selector;
+    emp::Random rnd(TEST_SEED);
+    emp::vector<size_t> winners;
+    selector.Select(scores, rnd, TEST_SELECTIONS, winners);
+    emp::vector<size_t> win_cnts(results[0].size(), 0);
+    for (size_t winner : winners) if (winner < win_cnts.size()) ++win_cnts[winner];
+    suite.Check(win_cnts[0] + win_cnts[1] == TEST_SELECTIONS, "every selection goes to organism 0 or 1");
+    suite.Check(win_cnts[0] > 0 && win_cnts[1] > 0, "ties between organisms 0 and 1 are broken at random");
+  });
+}
+
+/// Genome caching: duplicate genomes within an evaluation pass get evaluated once.
+void TestGenomeCacheDedupe(TestSuite & suite, MapElitesGPConfig & config) {
+  suite.Run("genome_cache/dedupe_pop", [&config, &suite]() {
+    ConfigOverrides overrides(config);
+    overrides.Set("WORLD_STRUCTURE", "0").Set("SELECTION_METHOD", "0").Set("SHUFFLE_TEST_CASES", "0")
+             .Set("TESTCASE_SAMPLING", "0").Set("GENOME_CACHE_SIZE", "4096").Set("EVAL_THREADS", emp::to_string(TEST_EVAL_THREADS))
+             .Set("DATA_DIRECTORY", "genome_cache_dedupe_pop/");
+    SetNoMutations(overrides);
+    emp::Random rnd(TEST_SEED);
+    SignalGPTestWorld world(rnd);
+    world.Setup(config);
+    world.Start();
+    // Selection without mutations fills the population with copies.
+    world.EvaluateAll();
+    world.SelectAndUpdate();
+    emp::Random order_rnd(TEST_SEED);
+    world.TestPopDedupe(suite, order_rnd);
+  });
+  suite.Run("genome_cache/dedupe_batch", [&config, &suite]() {
+    ConfigOverrides overrides(config);
+    overrides.Set("WORLD_STRUCTURE", "1").Set("SHUFFLE_TEST_CASES", "0").Set("TESTCASE_SAMPLING", "0")
+             .Set("GENOME_CACHE_SIZE", "4096").Set("MAPE_BATCH_SIZE", "64").Set("EVAL_THREADS", emp::to_string(TEST_EVAL_THREADS))
+             .Set("DATA_DIRECTORY", "genome_cache_dedupe_batch/");
+    SetNoMutations(overrides);
+    emp::Random rnd(TEST_SEED);
+    SignalGPTestWorld world(rnd);
+    world.Setup(config);
+    world.Start();
+    world.TestBatchDedupe(suite);
+  });
+}
+
+int main(int argc, char* argv[])
+{
+  std::string config_fname = "configs/MapElitesGPConfig.cfg";
+  std::string testcases_fpath = "configs/testcases/examples-squares.csv";
+  std::string scratch_dir = "test_scratch";
+  TestSuite suite;
+  // Pull out test options; everything else goes to the config.
+  emp::vector<char *> config_argv;
+  for (int i = 0; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    const bool has_val = i + 1 < argc;
+    if (has_val && arg == "--test-filter") suite.SetFilter(argv[++i]);
+    else if (has_val && arg == "--test-config") config_fname = argv[++i];
+    else if (has_val && arg == "--test-testcases") testcases_fpath = argv[++i];
+    else if (has_val && arg == "--test-scratch") scratch_dir = argv[++i];
+    else config_argv.emplace_back(argv[i]);
+  }
+  MapElitesGPConfig config;
+  config.Read(config_fname);
+  SetTestDefaults(config);
+  auto args = emp::cl::ArgManager((int)config_argv.size(), config_argv.data());
+  if (args.ProcessConfigOptions(config, std::cout, config_fname, "MapElitesGP-macros.h") == false) exit(0);
+  if (args.TestUnknown() == false) exit(0);  // If there are leftover args, throw an error.
+
+  // Everything happens in the scratch directory (worlds write data files and testcase caches); the testcase file is
+  // copied in, so its cache doesn't end up next to the original.
+  if (testcases_fpath[0] != '/') testcases_fpath = GetCwd() + "/" + testcases_fpath;
+  EnterDir(scratch_dir);
+  const std::string scratch_testcases_fpath = GetCwd() + "/" + testcases_fpath.substr(testcases_fpath.find_last_of('/') + 1);
+  CopyFile(testcases_fpath, scratch_testcases_fpath);
+  config.TESTCASES_FPATH(scratch_testcases_fpath);
+  config.PROBLEM_TYPE((size_t)MapElitesSignalGPWorld::PROBLEM_TYPE::TESTCASES);
+
+  TestWorkerPoolResize(suite);
+  TestGenomeInfo(suite, config);
+  TestEvalReproducibility(suite, config);
+  TestCheckpointResume(suite, config);
+  TestLexicaseNaN(suite);
+  TestGenomeCacheDedupe(suite, config);
+
+  return (suite.Report()) ? 0 : 1;
+}